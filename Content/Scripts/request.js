@@ -1,19 +1,25 @@
 (function () {
     "use strict"
     
+    // Copies the body as UTF-8 bytes and parses it off the game thread
+    function parseContent(req) {
+        let data = new ArrayBuffer(req.GetContentLength())
+        memory.exec(data, () => req.GetContentToMemory())
+        return parseJsonAsync(data)
+    }
+    
     function $get(url,succ,fail) {
         var req = new JavascriptHttpRequest()
         req.SetVerb("GET")
         req.SetURL(url)
         req.OnComplete.Add(function(success){
             if (success) {
-                try {
-                    var json = JSON.parse(req.GetContentAsString())
-                    succ(json)
-                    return    
-                }
-                catch (e) {                        
-                }          
+                parseContent(req).then(succ, () => {
+                    if (fail) {
+                        fail(req.GetResponseCode())
+                    }
+                })
+                return
             }
             if (fail) {
                 fail(req.GetResponseCode())
@@ -50,12 +56,7 @@
             req.OnComplete = (successful) => {
                 if (successful) {
                     if (res == "json") {
-                        try {
-                            resolve(JSON.parse(req.GetContentAsString()))
-                        }
-                        catch (e) {
-                            reject(new Error("Invalid JSON"))
-                        }
+                        parseContent(req).then(resolve, () => reject(new Error("Invalid JSON")))
                     } else if (res == "string") {
                         resolve(req.GetContentAsString())
                     } else if (res == "raw") {
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "Containers/Queue.h"
+
+/** Writes files on a dedicated thread, so that large dumps do not stall the game thread on disk I/O */
+class FAsyncFileWriter : public FRunnable
+{
+public:
+	/** Data appended to a file opened by Open */
+	class FFile
+	{
+	public:
+		FFile(FAsyncFileWriter& InWriter, FArchive* InAr)
+			: Writer(InWriter), Ar(InAr)
+		{}
+
+		~FFile()
+		{
+			Flush();
+			Writer.Enqueue(new FCommand{ Ar, TArray<uint8>(), true });
+		}
+
+		void Write(const void* Data, int32 Size)
+		{
+			Buffer.Append(reinterpret_cast<const uint8*>(Data), Size);
+
+			if (Buffer.Num() >= FlushThreshold)
+			{
+				Flush();
+			}
+		}
+
+		void Flush()
+		{
+			if (Buffer.Num())
+			{
+				Writer.Enqueue(new FCommand{ Ar, MoveTemp(Buffer), false });
+				Buffer.Reset();
+			}
+		}
+
+	private:
+		enum { FlushThreshold = 1024 * 1024 };
+
+		FAsyncFileWriter& Writer;
+		FArchive* Ar;
+		TArray<uint8> Buffer;
+	};
+
+	static FAsyncFileWriter& Get()
+	{
+		auto& Instance = GetInstance();
+		if (!Instance.IsValid())
+		{
+			Instance = MakeUnique<FAsyncFileWriter>();
+		}
+		return *Instance;
+	}
+
+	/** Waits until everything queued has been written */
+	static void Shutdown()
+	{
+		GetInstance().Reset();
+	}
+
+	FAsyncFileWriter()
+	{
+		WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+		Thread = FRunnableThread::Create(this, TEXT("JavascriptFileWriter"), 0, TPri_BelowNormal);
+	}
+
+	~FAsyncFileWriter()
+	{
+		bStopping = true;
+		WorkEvent->Trigger();
+
+		Thread->WaitForCompletion();
+		delete Thread;
+
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	}
+
+	/** Returns null when the file cannot be created; the file is closed once the returned object is destroyed and its data written */
+	TUniquePtr<FFile> Open(const FString& Filename)
+	{
+		auto Ar = IFileManager::Get().CreateFileWriter(*Filename, 0);
+		return Ar ? MakeUnique<FFile>(*this, Ar) : nullptr;
+	}
+
+	/** Writes the whole file at once */
+	bool WriteFile(const FString& Filename, TArray<uint8>&& Data)
+	{
+		auto Ar = IFileManager::Get().CreateFileWriter(*Filename, 0);
+		if (!Ar) return false;
+
+		Enqueue(new FCommand{ Ar, MoveTemp(Data), true });
+		return true;
+	}
+
+	// Begin FRunnable interface.
+	virtual uint32 Run() override
+	{
+		for (;;)
+		{
+			const bool bLastRound = bStopping;
+
+			FCommand* Command = nullptr;
+			while (Commands.Dequeue(Command))
+			{
+				Command->Ar->Serialize(Command->Data.GetData(), Command->Data.Num());
+				if (Command->bClose)
+				{
+					delete Command->Ar;
+				}
+				delete Command;
+			}
+
+			if (bLastRound)
+			{
+				return 0;
+			}
+
+			WorkEvent->Wait();
+		}
+	}
+	// End FRunnable interface.
+
+private:
+	struct FCommand
+	{
+		FArchive* Ar;
+		TArray<uint8> Data;
+		bool bClose;
+	};
+
+	static TUniquePtr<FAsyncFileWriter>& GetInstance()
+	{
+		static TUniquePtr<FAsyncFileWriter> Instance;
+		return Instance;
+	}
+
+	void Enqueue(FCommand* Command)
+	{
+		Commands.Enqueue(Command);
+		WorkEvent->Trigger();
+	}
+
+	TQueue<FCommand*, EQueueMode::Mpsc> Commands;
+	FEvent* WorkEvent{ nullptr };
+	FRunnableThread* Thread{ nullptr };
+	volatile bool bStopping{ false };
+};
@@ -14,7 +14,16 @@ public:
 	FWeakObjectPtr WeakObject;
 	UProperty* Property;
 	Persistent<Context> context_;
-	TMap<int32, UniquePersistent<Function>> functions;
+	/** A listener and its unique id */
+	struct FListener
+	{
+		int32 UniqueId;
+		UniquePersistent<Function> Handle;
+	};
+	/** Listeners in the order they were added, which is the order they are called in */
+	TArray<FListener> functions;
+	/** Maps identity hash of a listener to its unique id(s) */
+	TMultiMap<int32, int32> FunctionIdentityToUniqueIds;
 	Persistent<Object> WrappedObject;
 	Isolate* isolate_;
 	int32 NextUniqueId{ 0 };
@@ -27,7 +36,7 @@ public:
 
 	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
 	{
-		Collector.AddReferencedObjects(DelegateObjects);
+		Collector.AddReferencedObject(DispatcherObject);
 	}
 
 	FJavascriptDelegate(UObject* InObject, UProperty* InProperty)
@@ -47,7 +56,7 @@ public:
 
 			WrappedObject.Reset();
 
-			ClearDelegateObjects();
+			Clear();
 
 			context_.Reset();
 		}
@@ -107,23 +116,19 @@ public:
 			auto payload = reinterpret_cast<FJavascriptDelegate*>(Local<External>::Cast(info.Data())->Value());
 
 			uint32_t Index = 0;			
-			auto arr = Array::New(info.GetIsolate(), payload->DelegateObjects.Num());
+			auto arr = Array::New(info.GetIsolate(), payload->functions.Num());
 			const bool bIsMulticastDelegate = payload->Property->IsA(UMulticastDelegateProperty::StaticClass());
 
-			for (auto DelegateObject : payload->DelegateObjects)
+			for (auto& Listener : payload->functions)
 			{
-				auto JavascriptFunction = payload->functions.Find(DelegateObject->UniqueId);
-				if (JavascriptFunction)
+				auto function = Local<Function>::New(info.GetIsolate(), Listener.Handle);
+				if (!bIsMulticastDelegate)
 				{
-					auto function = Local<Function>::New(info.GetIsolate(), *JavascriptFunction);
-					if (!bIsMulticastDelegate)
-					{
-						info.GetReturnValue().Set(function);
-						return;
-					}
-					
-					arr->Set(Index++, function);
+					info.GetReturnValue().Set(function);
+					return;
 				}
+
+				arr->Set(Index++, function);
 			}
 
 			if (!bIsMulticastDelegate)
@@ -148,56 +153,68 @@ public:
 		return out;
 	}
 
-	TArray<UJavascriptDelegate*> DelegateObjects;
+	/** Single object bound to the engine delegate, which dispatches to all listeners */
+	UJavascriptDelegate* DispatcherObject{ nullptr };
+	bool bDispatcherBound{ false };
 
-	void ClearDelegateObjects()
+	void Add(Local<Function> function)
 	{
-		for (auto obj : DelegateObjects)
+		// Single-cast delegate holds only one listener
+		if (!Property->IsA(UMulticastDelegateProperty::StaticClass()))
 		{
-			obj->RemoveFromRoot();
+			RemoveAllListeners();
 		}
-		DelegateObjects.Empty();
-		functions.Empty();
-	}
 
-	void Add(Local<Function> function)
-	{
-		auto DelegateObject = NewObject<UJavascriptDelegate>();
+		auto UniqueId = NextUniqueId++;
+
+		functions.Add({ UniqueId, UniquePersistent<Function>(isolate_, function) });
+		FunctionIdentityToUniqueIds.Add(function->GetIdentityHash(), UniqueId);
 
-		DelegateObject->UniqueId = NextUniqueId++;
+		BindDispatcher();
+	}
 
-		Bind(DelegateObject, function);
+	UniquePersistent<Function>* FindListener(int32 UniqueId)
+	{
+		for (auto& Listener : functions)
+		{
+			if (Listener.UniqueId == UniqueId)
+			{
+				return &Listener.Handle;
+			}
+		}
+		return nullptr;
 	}
 
-	UJavascriptDelegate* FindJavascriptDelegateByFunction(Local<Function> function)
+	int32 FindUniqueIdByFunction(Local<Function> function)
 	{
 		HandleScope handle_scope(isolate_);
 
-		bool bWasSuccessful = false;
-		for (auto it = functions.CreateIterator(); it; ++it)
+		// Identity hash may collide, so candidates are compared
+		for (auto It = FunctionIdentityToUniqueIds.CreateConstKeyIterator(function->GetIdentityHash()); It; ++It)
 		{
-			if (Local<Function>::New(isolate_, it.Value())->Equals(function))
+			auto existing = FindListener(It.Value());
+			if (existing && Local<Function>::New(isolate_, *existing)->StrictEquals(function))
 			{
-				for (auto obj : DelegateObjects)
-				{
-					if (obj->UniqueId == it.Key())
-					{
-						return obj;
-					}
-				}
+				return It.Value();
 			}
 		}
 
-		return nullptr;
+		return INDEX_NONE;
 	}
 
 	void Remove(Local<Function> function)
 	{
-		auto obj = FindJavascriptDelegateByFunction(function);
+		auto UniqueId = FindUniqueIdByFunction(function);
 
-		if (obj)
+		if (UniqueId != INDEX_NONE)
 		{
-			Unbind(obj);
+			FunctionIdentityToUniqueIds.RemoveSingle(function->GetIdentityHash(), UniqueId);
+			functions.RemoveAll([UniqueId](const FListener& Listener) { return Listener.UniqueId == UniqueId; });
+
+			if (functions.Num() == 0)
+			{
+				UnbindDispatcher();
+			}
 		}
 		else
 		{
@@ -205,69 +222,89 @@ public:
 		}
 	}
 
+	void RemoveAllListeners()
+	{
+		functions.Empty();
+		FunctionIdentityToUniqueIds.Empty();
+	}
+
 	void Clear()
 	{
-		while (DelegateObjects.Num())
-		{
-			Unbind(DelegateObjects[0]);
-		}
+		RemoveAllListeners();
+
+		UnbindDispatcher();
 	}
 
-	void Bind(UJavascriptDelegate* DelegateObject, Local<Function> function)
+	void BindDispatcher()
 	{
 		static FName NAME_Fire("Fire");
 
-		if (WeakObject.IsValid())
+		if (!WeakObject.IsValid())
 		{
-			if (auto p = Cast<UMulticastDelegateProperty>(Property))
+			return;
+		}
+
+		if (!DispatcherObject)
+		{
+			DispatcherObject = NewObject<UJavascriptDelegate>();
+			DispatcherObject->JavascriptDelegate = AsShared();
+		}
+
+		if (auto p = Cast<UMulticastDelegateProperty>(Property))
+		{
+			if (!bDispatcherBound)
 			{
 				FScriptDelegate Delegate;
-				Delegate.BindUFunction(DelegateObject, NAME_Fire);
+				Delegate.BindUFunction(DispatcherObject, NAME_Fire);
 
 				auto Target = p->GetPropertyValuePtr_InContainer(WeakObject.Get());
 				Target->Add(Delegate);
 			}
-			else if (auto p = Cast<UDelegateProperty>(Property))
+		}
+		else if (auto p = Cast<UDelegateProperty>(Property))
+		{
+			// Another wrapper of the property, or native code, may have rebound it since
+			auto Target = p->GetPropertyValuePtr_InContainer(WeakObject.Get());
+			if (Target->GetUObject() != DispatcherObject)
 			{
-				auto Target = p->GetPropertyValuePtr_InContainer(WeakObject.Get());
-				Target->BindUFunction(DelegateObject, NAME_Fire);
+				Target->BindUFunction(DispatcherObject, NAME_Fire);
 			}
 		}
 
-		DelegateObject->JavascriptDelegate = AsShared();
-		DelegateObjects.Add(DelegateObject);
-
-		functions.Add( DelegateObject->UniqueId, UniquePersistent<Function>(isolate_, function) );
+		bDispatcherBound = true;
 	}
 
-	void Unbind(UJavascriptDelegate* DelegateObject)
+	void UnbindDispatcher()
 	{
 		static FName NAME_Fire("Fire");
 
+		if (!bDispatcherBound)
+		{
+			return;
+		}
+
 		if (WeakObject.IsValid())
 		{
 			if (auto p = Cast<UMulticastDelegateProperty>(Property))
 			{
 				FScriptDelegate Delegate;
-				Delegate.BindUFunction(DelegateObject, NAME_Fire);
+				Delegate.BindUFunction(DispatcherObject, NAME_Fire);
 
 				auto Target = p->GetPropertyValuePtr_InContainer(WeakObject.Get());
 				Target->Remove(Delegate);
 			}
 			else if (auto p = Cast<UDelegateProperty>(Property))
 			{
+				// Leaves a binding made by someone else alone
 				auto Target = p->GetPropertyValuePtr_InContainer(WeakObject.Get());
-				Target->Clear();
+				if (Target->GetUObject() == DispatcherObject)
+				{
+					Target->Clear();
+				}
 			}
 		}
 
-		DelegateObject->JavascriptDelegate.Reset();
-		DelegateObjects.Remove(DelegateObject);
-
-		if (!bAbandoned)
-		{
-			functions.Remove(DelegateObject->UniqueId);
-		}
+		bDispatcherBound = false;
 	}
 
 	UFunction* GetSignatureFunction()
@@ -286,46 +323,65 @@ public:
 		}
 	}
 
-	void Fire(void* Parms, UJavascriptDelegate* Delegate)
+	void Fire(void* Parms)
 	{
 		SCOPE_CYCLE_COUNTER(STAT_JavascriptDelegate);
 
-		if (!Delegate->IsValidLowLevelFast())
+		if (!WeakObject.IsValid() || functions.Num() == 0)
 		{
 			return;
 		}
 
-		auto Buffer = reinterpret_cast<uint8*>(Parms);		
+		Isolate::Scope isolate_scope(isolate_);
+		HandleScope handle_scope(isolate_);
+
+		auto context = Local<Context>::New(isolate_, context_);
 
-		auto it = functions.Find(Delegate->UniqueId);
-		if (WeakObject.IsValid() && it)
+		Context::Scope context_sopce(context);
+
+		// Listeners may add or remove listeners while being called
+		TArray<int32> UniqueIds;
+		for (const auto& Listener : functions)
 		{
-			Isolate::Scope isolate_scope(isolate_);
-			HandleScope handle_scope(isolate_);
+			UniqueIds.Add(Listener.UniqueId);
+		}
 
-			auto func = Local<Function>::New(isolate_, *it);
-			if (!func.IsEmpty())
-			{
-				auto context = Local<Context>::New(isolate_, context_);
+		auto SignatureFunction = GetSignatureFunction();
 
-				Context::Scope context_sopce(context);
+		for (auto UniqueId : UniqueIds)
+		{
+			if (bAbandoned)
+			{
+				break;
+			}
 
-				CallJavascriptFunction(context, context->Global(), GetSignatureFunction(), func, Parms);
+			auto it = FindListener(UniqueId);
+			if (it)
+			{
+				auto func = Local<Function>::New(isolate_, *it);
+				if (!func.IsEmpty())
+				{
+					CallJavascriptFunction(context, context->Global(), SignatureFunction, func, Parms);
+				}
 			}
 		}
 	}
 };
 
-struct FDelegateManager : IDelegateManager
+struct FDelegateManager : IDelegateManager, FUObjectArray::FUObjectDeleteListener
 {
 	Isolate* isolate_;
 
 	FDelegateManager(Isolate* isolate)
 		: isolate_(isolate)
-	{}
+	{
+		GUObjectArray.AddUObjectDeleteListener(this);
+	}
 
 	virtual ~FDelegateManager()
 	{
+		GUObjectArray.RemoveUObjectDeleteListener(this);
+
 		PurgeAllDelegates();
 	}
 
@@ -334,18 +390,13 @@ struct FDelegateManager : IDelegateManager
 		delete this;
 	}
 
-	TSet<TSharedPtr<FJavascriptDelegate>> Delegates;
+	/** Maps an object to delegates created for its properties */
+	TMultiMap<const UObjectBase*, TSharedPtr<FJavascriptDelegate>> Delegates;
 
-	void CollectGarbageDelegates()
+	// Delegates of an object are released as soon as the object goes away
+	virtual void NotifyUObjectDeleted(const UObjectBase* Object, int32 Index) override
 	{
-		for (auto it = Delegates.CreateIterator(); it; ++it)
-		{
-			auto d = *it;
-			if (!d->IsValid())
-			{
-				it.RemoveCurrent();
-			}
-		}
+		Delegates.Remove(Object);
 	}
 
 	void PurgeAllDelegates()
@@ -355,13 +406,10 @@ struct FDelegateManager : IDelegateManager
 
 	Local<Object> CreateDelegate(UObject* Object, UProperty* Property)
 	{
-		//@HACK
-		CollectGarbageDelegates();
-
 		TSharedPtr<FJavascriptDelegate> payload = MakeShareable(new FJavascriptDelegate(Object, Property));
 		auto created = payload->Initialize(isolate_->GetCurrentContext());
 
-		Delegates.Add(payload);
+		Delegates.Add(Object, payload);
 
 		return created;
 	}
@@ -399,7 +447,7 @@ void UJavascriptDelegate::ProcessEvent(UFunction* Function, void* Parms)
 {
 	if (JavascriptDelegate.IsValid())
 	{
-		JavascriptDelegate.Pin()->Fire(Parms, this);
+		JavascriptDelegate.Pin()->Fire(Parms);
 	}
 }
 
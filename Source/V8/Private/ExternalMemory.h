@@ -0,0 +1,48 @@
+#pragma once
+
+#include "JavascriptStats.h"
+
+/** Reports native memory kept alive by V8 objects, so that V8 takes it into account when scheduling GC */
+struct FExternalMemory
+{
+	static void Adjust(v8::Isolate* isolate, int64 Delta)
+	{
+		if (Delta == 0) return;
+
+		isolate->AdjustAmountOfExternalAllocatedMemory(Delta);
+
+		if (Delta > 0)
+		{
+			INC_MEMORY_STAT_BY(STAT_JavascriptExternalMemory, Delta);
+		}
+		else
+		{
+			DEC_MEMORY_STAT_BY(STAT_JavascriptExternalMemory, -Delta);
+		}
+	}
+
+	/** Reports Size bytes until Holder is collected */
+	static void Track(v8::Isolate* isolate, v8::Local<v8::Object> Holder, int64 Size)
+	{
+		if (Size <= 0) return;
+
+		Adjust(isolate, Size);
+
+		auto Tracked = new FExternalMemory;
+		Tracked->Size = Size;
+		Tracked->Handle.Reset(isolate, Holder);
+		Tracked->Handle.SetWeak(Tracked, [](const v8::WeakCallbackInfo<FExternalMemory>& data) {
+			auto Tracked = data.GetParameter();
+
+			// Decreasing never triggers GC, so it is safe within weak callback
+			Adjust(data.GetIsolate(), -Tracked->Size);
+
+			Tracked->Handle.Reset();
+			delete Tracked;
+		}, v8::WeakCallbackType::kParameter);
+	}
+
+private:
+	v8::Global<v8::Object> Handle;
+	int64 Size;
+};
@@ -15,16 +15,29 @@ PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
 #include "Paths.h"
 #include "JavascriptIsolate_Private.h"
 #include "PropertyPortFlags.h"
+#include "ScriptArchive.h"
+#include "JsonParseJob.h"
 
 #if WITH_EDITOR
 #include "TypingsGenerator.h"
 #endif
 
 #include "Helpers.h"
+#include "ExternalMemory.h"
 #include "JavascriptGeneratedClass_Native.h"
 #include "JavascriptGeneratedClass.h"
 #include "JavascriptGeneratedFunction.h"
 #include "StructMemoryInstance.h"
+#include "JavascriptSettings.h"
+#include "ScriptCodeCache.h"
+#include "DirectoryWatcher.h"
+#include "Ticker.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#if V8_ENABLE_DIRECTORY_WATCHER
+#include "ModuleManager.h"
+#include "DirectoryWatcherModule.h"
+#endif
 
 #include "JavascriptStats.h"
 
@@ -53,6 +66,107 @@ static FString URLToLocalPath(FString URL)
 	return URL;
 }
 
+/** CommonJS wrapper which require puts around a module, in two halves so that the code in between need not be copied */
+static const TCHAR* ModuleSourcePrefix =
+	TEXT("(function (global, __filename, __dirname, __hot) {"
+		 "  var module = { exports: {}, filename : __filename, hot : __hot }, exports = module.exports;"
+		 "  (function() { ");
+
+static FString GetModuleSourceSuffix(const FString& FullPath)
+{
+	return FString::Printf(
+		TEXT("\n})();\n"
+			 "  return module.exports;\n"
+			 "}(this, '%s', '%s', require.hot('%s')));"),
+		*FullPath, *FPaths::GetPath(FullPath), *FullPath.ReplaceCharWithEscapedChar()
+	);
+}
+
+static FString WrapModuleSource(const FString& Code, const FString& FullPath)
+{
+	return ModuleSourcePrefix + Code + GetModuleSourceSuffix(FullPath);
+}
+
+/** Module compiled on a background thread, for requireAsync or the preload list */
+struct FStreamingCompile
+{
+	FStreamingCompile(const FString& InFullPath);
+
+	FString FullPath;
+
+	/** Wrapped source, written on the background thread before parsing starts */
+	FString Text;
+	bool bLoaded{ false };
+
+	ScriptCompiler::StreamedSource Source;
+	TUniquePtr<ScriptCompiler::ScriptStreamingTask> Task;
+	FGraphEventRef Event;
+
+	/** Settled with the module exports; empty for preloads, which are compiled but not run */
+	Global<Promise::Resolver> Resolver;
+};
+
+/** Runs the parse on V8's background threads; task graph workers lack the stack V8 expects */
+class FStreamingCompileTask : public v8::Task
+{
+public:
+	FStreamingCompileTask(ScriptCompiler::ScriptStreamingTask* InTask, FGraphEventRef InEvent)
+		: Task(InTask), Event(InEvent)
+	{}
+
+	virtual void Run() override
+	{
+		Task->Run();
+		Event->DispatchSubsequents();
+	}
+
+private:
+	ScriptCompiler::ScriptStreamingTask* Task;
+	FGraphEventRef Event;
+};
+
+/** Reads and wraps the module file when V8 asks for data, which happens on the background thread */
+class FModuleSourceStream : public ScriptCompiler::ExternalSourceStream
+{
+public:
+	FModuleSourceStream(FStreamingCompile& InJob)
+		: Job(InJob)
+	{}
+
+	virtual size_t GetMoreData(const uint8_t** src) override
+	{
+		if (bDone)
+		{
+			return 0;
+		}
+		bDone = true;
+
+		FString Code;
+		if (!FScriptArchive::LoadFileToString(Code, Job.FullPath))
+		{
+			return 0;
+		}
+
+		Job.Text = WrapModuleSource(Code, Job.FullPath);
+		Job.bLoaded = true;
+
+		// V8 takes ownership of the chunk
+		FTCHARToUTF8 Utf8(*Job.Text);
+		auto Chunk = new uint8_t[Utf8.Length()];
+		FMemory::Memcpy(Chunk, Utf8.Get(), Utf8.Length());
+		*src = Chunk;
+		return Utf8.Length();
+	}
+
+private:
+	FStreamingCompile& Job;
+	bool bDone{ false };
+};
+
+FStreamingCompile::FStreamingCompile(const FString& InFullPath)
+	: FullPath(InFullPath), Source(new FModuleSourceStream(*this), ScriptCompiler::StreamedSource::UTF8)
+{}
+
 static TArray<FString> StringArrayFromV8(Handle<Value> InArray)
 {
 	TArray<FString> OutArray;
@@ -541,53 +655,29 @@ void UJavascriptGeneratedFunction::Thunk(FFrame& Stack, RESULT_DECL)
 				return;
 			}
 
-			UProperty* ReturnProp = ((UFunction*)Stack.Node)->GetReturnProperty();
+			UProperty* ReturnProp = Function->ReturnParam;
 			if (ReturnProp != NULL)
 			{
-				const bool bHasReturnParam = Function->ReturnValueOffset != MAX_uint16;
-				uint8* ReturnValueAdress = bHasReturnParam ? (Stack.Locals + Function->ReturnValueOffset) : nullptr;
-				if (ReturnValueAdress)
-					FMemory::Memcpy(RESULT_PARAM, ReturnValueAdress, ReturnProp->ArrayDim * ReturnProp->ElementSize);
+				FMemory::Memcpy(RESULT_PARAM, Stack.Locals + Function->ReturnValueOffset, ReturnProp->ArrayDim * ReturnProp->ElementSize);
 			}
 
-			bool bHasAnyOutParams = false;
-			if (Function && Function->HasAnyFunctionFlags(FUNC_HasOutParms))
+			// Write back 'out ref' parameters
+			auto OutParm = Stack.OutParms;
+			for (auto bCopy : Function->OutParmsToCopy)
 			{
-				// Iterate over input parameters
-				for (TFieldIterator<UProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It)
+				if (OutParm == nullptr)
 				{
-					// This is 'out ref'!
-					if ((It->PropertyFlags & (CPF_ConstParm | CPF_OutParm)) == CPF_OutParm)
-					{
-						bHasAnyOutParams = true;
-						break;
-					}
+					break;
 				}
-			}
 
-			if (bHasAnyOutParams)
-			{
-				auto OutParm = Stack.OutParms;
-
-				// Iterate over parameters again
-				for (TFieldIterator<UProperty> It(Function); It; ++It)
+				auto Property = OutParm->Property;
+				if (bCopy && Property != nullptr)
 				{
-					UProperty* Param = *It;
-
-					auto PropertyFlags = Param->GetPropertyFlags();
-					if ((PropertyFlags & (CPF_ConstParm | CPF_OutParm)) == CPF_OutParm)
-					{
-						auto Property = OutParm->Property;
-						if (Property != nullptr)
-						{
-							auto ValueAddress = Property->ContainerPtrToValuePtr<uint8>(Stack.Locals);
-							FMemory::Memcpy(OutParm->PropAddr, ValueAddress, Property->ArrayDim * Property->ElementSize);
-						}
-					}
-
-					if (PropertyFlags & CPF_OutParm)
-						OutParm = OutParm->NextOutParm;
+					auto ValueAddress = Property->ContainerPtrToValuePtr<uint8>(Stack.Locals);
+					FMemory::Memcpy(OutParm->PropAddr, ValueAddress, Property->ArrayDim * Property->ElementSize);
 				}
+
+				OutParm = OutParm->NextOutParm;
 			}
 		}
 	};
@@ -603,34 +693,26 @@ void UJavascriptGeneratedFunction::Thunk(FFrame& Stack, RESULT_DECL)
 		if (!bUsePersistentFrame)
 		{
 			Frame = (uint8*)FMemory_Alloca(Function->PropertiesSize);
-			FMemory::Memzero(Frame, Function->PropertiesSize);
+			if (Function->bFrameNeedsZeroing)
+			{
+				FMemory::Memzero(Frame, Function->PropertiesSize);
+			}
 		}
 		FFrame NewStack(this, Function, Frame, &Stack, Function->Children);
 		FOutParmRec** LastOut = &NewStack.OutParms;
 		UProperty* Property;
 
 		// Check to see if we need to handle a return value for this function.  We need to handle this first, because order of return parameters isn't always first.
-		if (Function->HasAnyFunctionFlags(FUNC_HasOutParms))
+		if (Function->ReturnParam && Function->HasAnyFunctionFlags(FUNC_HasOutParms))
 		{
-			// Iterate over the function parameters, searching for the ReturnValue
-			for (TFieldIterator<UProperty> ParmIt(Function); ParmIt; ++ParmIt)
-			{
-				Property = *ParmIt;
-				if (Property->HasAnyPropertyFlags(CPF_ReturnParm))
-				{
-					CA_SUPPRESS(6263)
-					FOutParmRec* RetVal = (FOutParmRec*)FMemory_Alloca(sizeof(FOutParmRec));
-
-					// Our context should be that we're in a variable assignment to the return value, so ensure that we have a valid property to return to
-					check(RESULT_PARAM != NULL);
-					RetVal->PropAddr = (uint8*)RESULT_PARAM;
-					RetVal->Property = Property;
-					NewStack.OutParms = RetVal;
-
-					// A function can only have one return value, so we can stop searching
-					break;
-				}
-			}
+			CA_SUPPRESS(6263)
+			FOutParmRec* RetVal = (FOutParmRec*)FMemory_Alloca(sizeof(FOutParmRec));
+
+			// Our context should be that we're in a variable assignment to the return value, so ensure that we have a valid property to return to
+			check(RESULT_PARAM != NULL);
+			RetVal->PropAddr = (uint8*)RESULT_PARAM;
+			RetVal->Property = Function->ReturnParam;
+			NewStack.OutParms = RetVal;
 		}
 
 		for (Property = (UProperty*)Function->Children; *Stack.Code != EX_EndFunctionParms; Property = (UProperty*)Property->Next)
@@ -772,6 +854,75 @@ public:
 	TMap<FString, v8::Global<v8::Function>> NativeModules;
 	TArray<FString>& Paths;
 
+	/** Proxy functions of a generated class, resolved once when the class is created. */
+	struct FProxyFunctionTable
+	{
+		v8::Global<v8::Function> PreConstructor;
+		v8::Global<v8::Function> Constructor;
+		TMap<UFunction*, v8::Global<v8::Function>> Functions;
+	};
+
+	/** Maps a generated class to its proxy functions, inherited ones included. Classes are not kept alive by it. */
+	TMap<TWeakObjectPtr<UClass>, FProxyFunctionTable> ProxyFunctionTables;
+	/** Maps a function name to its safeified V8 keyword, for objects which hold 'proxy' themselves. */
+	TMap<FName, v8::Global<v8::String>> ProxyFunctionNames;
+	/** Objects whose wrapper holds a 'proxy', so that events of other objects need not look at their wrappers. */
+	TSet<TWeakObjectPtr<UObject>> ObjectsWithProxy;
+	/** Private key 'proxy' is held by on a wrapper, so that it dies with the wrapper. */
+	v8::Global<v8::Private> ObjectProxyKey;
+
+	/** Wrapper counts of the previous wrapper report, to tell growth. */
+	TMap<TWeakObjectPtr<UStruct>, int32> LastWrapperCounts;
+
+	/** Modules compiled ahead of time which have not been required yet. */
+	TMap<FString, v8::Global<Script>> PreloadedScripts;
+	/** Background compiles in flight; the isolate must outlive them. */
+	TArray<TUniquePtr<FStreamingCompile>> StreamingCompiles;
+	/** JSON texts being decoded in the background, settled by the same ticker as the compiles. */
+	TArray<TUniquePtr<FJsonParseJob>> JsonParses;
+	FDelegateHandle StreamingTickHandle;
+
+	enum class EPathKind : uint8
+	{
+		Missing,
+		File,
+		Directory
+	};
+
+	/** Resolved module filename by module filename and directory; empty when it could not be resolved. */
+	TMap<FString, FString> ResolvedModuleFilenames;
+	/** "main" of package.json by package directory. */
+	TMap<FString, FString> PackageMains;
+	/** Probed paths, so that every node_modules candidate is stat()ed once; missing ones only within watched directories. */
+	TMap<FString, EPathKind> PathKinds;
+	/** Set when a probe missed outside watched directories and was not cached, so that neither is what rests on it. */
+	bool bUncachedProbe{ false };
+	/** Search paths the resolution cache was filled with. */
+	TArray<FString> ResolvedSearchPaths;
+#if V8_ENABLE_DIRECTORY_WATCHER
+	TMap<FString, FDelegateHandle> WatchedDirectories;
+#endif
+
+	/** ES modules by absolute path (or native module specifier), compiled when first imported. */
+	TMap<FString, v8::Global<Module>> EsModules;
+	/** Module paths by identity hash, to tell the importing module within the resolve callback; hashes are not unique. */
+	TMultiMap<int32, FString> EsModulePaths;
+
+	/** What a module asked for through `module.hot` when it was last evaluated. */
+	struct FHotModule
+	{
+		bool bSelfAccepted{ false };
+		/** Handler by dependency path, run with the new exports once the dependency was reloaded. */
+		TMap<FString, v8::Global<v8::Function>> AcceptedDependencies;
+		TArray<v8::Global<v8::Function>> DisposeHandlers;
+		/** Filled in by the dispose handlers, for the next instance to pick up as `module.hot.data`. */
+		v8::Global<v8::Object> Data;
+	};
+
+	/** Paths of the scripts which required a module, by module path. */
+	TMap<FString, TSet<FString>> ModuleImporters;
+	TMap<FString, FHotModule> HotModules;
+
 	void SetAsDebugContext(int32 InPort)
 	{
 		if (debugger) return;
@@ -835,10 +986,16 @@ public:
 		ExposeGlobals();
 
 		Paths = IV8::Get().GetGlobalScriptSearchPaths();
+
+		PreloadModules(GetDefault<UJavascriptSettings>()->PreloadModules);
 	}
 
 	~FJavascriptContextImplementation()
 	{
+		CancelStreamingCompiles();
+
+		UnwatchSearchPaths();
+
 		PurgeModules();
 
 		ReleaseAllPersistentHandles();
@@ -855,7 +1012,17 @@ public:
 		ObjectToObjectMap.Empty();
 
 		// Release all struct instances
+		for (auto& Pair : MemoryToObjectMap)
+		{
+			FExternalMemory::Adjust(isolate(), -Pair.Key->GetOwnedSize());
+		}
 		MemoryToObjectMap.Empty();
+
+		// Release all proxy functions
+		ProxyFunctionTables.Empty();
+		ProxyFunctionNames.Empty();
+		ObjectsWithProxy.Empty();
+		ObjectProxyKey.Reset();
 	}
 
 	void ExposeGlobals()
@@ -874,152 +1041,517 @@ public:
 	{
 		Modules.Empty();
 		NativeModules.Empty();
+		PreloadedScripts.Empty();
+		EsModules.Empty();
+		EsModulePaths.Empty();
+		ModuleImporters.Empty();
+		HotModules.Empty();
+
+		InvalidateResolutionCache();
 	}
 
 	/**
-	* Expose the CreateClass function in the global V8 scope.
+	* Compiles a module unless it is loaded already; Source is only asked for when it is not.
+	* Throws within the isolate on failure.
 	*/
-	void ExposeCreateClass()
+	MaybeLocal<Module> CompileEsModule(const FString& Key, const FString& Filename, TFunctionRef<bool(FString&)> Source)
 	{
-		auto fn = [](const FunctionCallbackInfo<Value>& info) {
-			auto Context = reinterpret_cast<FJavascriptContextImplementation*>((Local<External>::Cast(info.Data()))->Value());
+		if (auto it = EsModules.Find(Key))
+		{
+			return Local<Module>::New(isolate(), *it);
+		}
 
-			auto isolate = info.GetIsolate();
+		FString code;
+		if (!Source(code))
+		{
+			isolate()->ThrowException(Exception::Error(V8_String(isolate(), FString::Printf(TEXT("Cannot load module %s"), *Key))));
+			return MaybeLocal<Module>();
+		}
 
-			FIsolateHelper I(isolate);
+		ScriptOrigin origin(V8_String(isolate(), GetScriptURL(Filename)),
+			Local<Integer>(), Local<Integer>(), Local<Boolean>(), Local<Integer>(), Local<Value>(), Local<Boolean>(), Local<Boolean>(),
+			True(isolate()));
+		ScriptCompiler::Source source(V8_String(isolate(), code), origin);
 
-			HandleScope scope(isolate);
+		Local<Module> module;
+		if (!ScriptCompiler::CompileModule(isolate(), &source).ToLocal(&module))
+		{
+			return MaybeLocal<Module>();
+		}
 
-			auto Name = StringFromV8(info[0]);
-			auto Opts = info[1]->ToObject();
-			auto Outer = UObjectFromV8(Opts->Get(I.Keyword("Outer")));
-			auto ParentClass = UClassFromV8(isolate, Opts->Get(I.Keyword("Parent")));
-			Outer = Outer ? Outer : GetTransientPackage();
-			ParentClass = ParentClass ? ParentClass : UObject::StaticClass();
+		EsModules.Add(Key, v8::Global<Module>(isolate(), module));
+		EsModulePaths.Add(module->GetIdentityHash(), Key);
+		return module;
+	}
 
-			UBlueprintGeneratedClass* Class = nullptr;
-			if (Cast<UBlueprintGeneratedClass>(ParentClass))
+	/** Drops a compiled module, so that the next import compiles it again */
+	void RemoveEsModule(const FString& Key)
+	{
+		if (auto it = EsModules.Find(Key))
+		{
+			EsModulePaths.RemoveSingle(Local<Module>::New(isolate(), *it)->GetIdentityHash(), Key);
+			EsModules.Remove(Key);
+		}
+	}
+
+	/** Path of a compiled module; empty if it is not known */
+	FString GetEsModulePath(Local<Module> module)
+	{
+		for (auto It = EsModulePaths.CreateConstKeyIterator(module->GetIdentityHash()); It; ++It)
+		{
+			auto Module = EsModules.Find(It.Value());
+			if (Module && *Module == module)
 			{
-				auto Klass = NewObject<UJavascriptGeneratedClass>(Outer, *Name, RF_Public);
-				Klass->JavascriptContext = Context->AsShared();
-				Class = Klass;
+				return It.Value();
 			}
-			else
+		}
+		return FString();
+	}
+
+	/**
+	* Resolves specifier as require does, relative to baseDirectory.
+	* .mjs files are ES modules; CommonJS, JSON and native modules come through require and become the default export.
+	*/
+	MaybeLocal<Module> LoadEsModule(const FString& specifier, const FString& baseDirectory)
+	{
+		FString nativeModulePrefix(TEXT("jsue/"));
+		if (specifier.StartsWith(nativeModulePrefix, ESearchCase::CaseSensitive))
+		{
+			return CompileEsModule(specifier, specifier, [&](FString& code)
 			{
-				auto Klass = NewObject<UJavascriptGeneratedClass_Native>(Outer, *Name, RF_Public);
-				Klass->JavascriptContext = Context->AsShared();
-				Class = Klass;
+				code = FString::Printf(TEXT("export default require('%s');"), *specifier.ReplaceCharWithEscapedChar());
+				return true;
+			});
+		}
 
-				// This flag is necessary for proper initialization
-				Class->ClassFlags |= CLASS_Native;
+		auto resolvedModuleFilename = ResolveModuleFilename(specifier, baseDirectory);
+		if (resolvedModuleFilename.IsEmpty())
+		{
+			isolate()->ThrowException(Exception::Error(V8_String(isolate(), FString::Printf(TEXT("Cannot find module %s"), *specifier))));
+			return MaybeLocal<Module>();
+		}
+
+		auto fullPath = GetModuleCacheKey(resolvedModuleFilename);
+		return CompileEsModule(fullPath, fullPath, [&](FString& code)
+		{
+			if (fullPath.EndsWith(TEXT(".mjs")))
+			{
+				return FScriptArchive::LoadFileToString(code, fullPath);
 			}
 
-			// Create a blueprint
-			auto Blueprint = NewObject<UBlueprint>(Outer);
-			Blueprint->GeneratedClass = Class;
-			Class->ClassGeneratedBy = Blueprint;
+			code = FString::Printf(TEXT("export default require('%s');"), *fullPath.ReplaceCharWithEscapedChar());
+			return true;
+		});
+	}
 
-			auto ClassConstructor = [](const FObjectInitializer& ObjectInitializer){
-				auto Class = static_cast<UBlueprintGeneratedClass*>(CurrentClassUnderConstruction ? CurrentClassUnderConstruction : ObjectInitializer.GetClass());
-				CurrentClassUnderConstruction = nullptr;
+	static MaybeLocal<Module> ResolveEsModule(Local<Context> context, Local<String> specifier, Local<Module> referrer)
+	{
+		auto self = static_cast<FJavascriptContextImplementation*>(FJavascriptContext::FromV8(context));
 
-				FJavascriptContextImplementation* Context = nullptr;
+		auto referrerPath = self->GetEsModulePath(referrer);
+		return self->LoadEsModule(StringFromV8(specifier), FPaths::GetPath(referrerPath));
+	}
 
-				if (auto Klass = Cast<UJavascriptGeneratedClass_Native>(Class))
-				{
-					if (Klass->JavascriptContext.IsValid())
-					{
-						Context = static_cast<FJavascriptContextImplementation*>(Klass->JavascriptContext.Pin().Get());
-					}
-				}
-				else if (auto Klass = Cast<UJavascriptGeneratedClass>(Class))
-				{
-					if (Klass->JavascriptContext.IsValid())
-					{
-						Context = static_cast<FJavascriptContextImplementation*>(Klass->JavascriptContext.Pin().Get());
-					}
-				}
+	/** Links the module graph on first use and runs it; a module which has run already does nothing */
+	bool EvaluateEsModule(Local<Module> module)
+	{
+		auto context = this->context();
+		return module->Instantiate(context, &FJavascriptContextImplementation::ResolveEsModule) && !module->Evaluate(context).IsEmpty();
+	}
 
-				if (Context)
-				{
-					auto isolate = Context->isolate();
-					auto Object = ObjectInitializer.GetObj();
+	/** import() from any script; dependencies are loaded only now, which makes rarely used subsystems lazy */
+	void ImportEsModule(const FString& specifier, const FString& referrer, Local<DynamicImportResult> result)
+	{
+		HandleScope handle_scope(isolate());
+		auto context = this->context();
 
-					FIsolateHelper I(isolate);
+		TryCatch try_catch;
 
-					Isolate::Scope isolate_scope(isolate);
-					HandleScope handle_scope(isolate);
-					Context::Scope context_scope(Context->context());
+		Local<Module> module;
+		if (LoadEsModule(specifier, FPaths::GetPath(URLToLocalPath(referrer))).ToLocal(&module) && EvaluateEsModule(module))
+		{
+			(void)result->FinishDynamicImportSuccess(context, module);
+		}
+		else
+		{
+			auto exception = try_catch.HasCaught() ? try_catch.Exception() : Exception::Error(V8_String(isolate(), FString::Printf(TEXT("Cannot import %s"), *specifier)));
+			try_catch.Reset();
+			(void)result->FinishDynamicImportFailure(context, exception);
+		}
+	}
 
-					auto Holder = Context->ExportObject(Class);
+	void Public_RunModule(const FString& Filename)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		HandleScope handle_scope(isolate());
+		Context::Scope context_scope(context());
 
-					auto v8_obj = Holder->ToObject();
-					auto proxy = v8_obj->Get(I.Keyword("proxy"));
-					if (proxy.IsEmpty() || !proxy->IsObject())
-					{
-						I.Throw(TEXT("Invalid proxy : construct class"));
-						return;
-					}
+		TryCatch try_catch;
 
-					Context->ObjectInitializerStack.Add(&ObjectInitializer);
+		Local<Module> module;
+		if (!LoadEsModule(GetScriptFileFullPath(Filename), FString()).ToLocal(&module) || !EvaluateEsModule(module))
+		{
+			UncaughtException(FV8Exception::Report(try_catch));
+		}
+	}
 
-					auto This = Context->ExportObject(Object);
+	/** Starts compiling modules in the background, so that requiring them later only runs them */
+	void PreloadModules(const TArray<FString>& ModuleNames)
+	{
+		for (const auto& ModuleName : ModuleNames)
+		{
+			auto resolvedModuleFilename = ResolveModuleFilename(ModuleName, FString());
+			if (resolvedModuleFilename.EndsWith(TEXT(".js")))
+			{
+				StartStreamingCompile(GetModuleCacheKey(resolvedModuleFilename));
+			}
+			else
+			{
+				UE_LOG(Javascript, Warning, TEXT("Cannot preload %s"), *ModuleName);
+			}
+		}
+	}
 
-					auto context = Context->context();
+	FStreamingCompile* StartStreamingCompile(const FString& FullPath)
+	{
+		auto Job = new FStreamingCompile(FullPath);
+		StreamingCompiles.Add(TUniquePtr<FStreamingCompile>(Job));
 
-					{
-						auto func = proxy->ToObject()->Get(I.Keyword("prector"));
+		Job->Task.Reset(ScriptCompiler::StartStreamingScript(isolate(), &Job->Source));
 
-						if (func->IsFunction())
-						{
-							CallJavascriptFunction(context, This, nullptr, Local<Function>::Cast(func), nullptr);
-						}
-					}
+		// Completed by the task, so that the ticker and cancellation can go by the event
+		Job->Event = FGraphEvent::CreateGraphEvent();
+		IV8::Get().CallOnBackgroundThread(new FStreamingCompileTask(Job->Task.Get(), Job->Event));
 
-					CallClassConstructor(Class->GetSuperClass(), ObjectInitializer);
+		StartStreamingTicker();
 
-					{
-						auto func = proxy->ToObject()->Get(I.Keyword("ctor"));
+		return Job;
+	}
 
-						if (func->IsFunction())
-						{
-							CallJavascriptFunction(context, This, nullptr, Local<Function>::Cast(func), nullptr);
-						}
-					}
+	/** Reads, validates and decodes on a background thread; the value is built on the next tick */
+	void StartJsonParse(TUniquePtr<FJsonParseJob> Job, Local<Promise::Resolver> Resolver)
+	{
+		Job->Resolver.Reset(isolate(), Resolver);
 
-					Context->ObjectInitializerStack.RemoveAt(Context->ObjectInitializerStack.Num() - 1, 1);
-				}
-				else
-				{
-					CallClassConstructor(Class->GetSuperClass(), ObjectInitializer);
-				}
-			};
+		auto Task = Job.Get();
+		Job->Event = FFunctionGraphTask::CreateAndDispatchWhenReady([Task]()
+		{
+			Task->Run();
+		}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
 
-			Class->ClassConstructor = ClassConstructor;
+		JsonParses.Add(MoveTemp(Job));
 
-			// Set properties we need to regenerate the class with
-			Class->PropertyLink = ParentClass->PropertyLink;
-			Class->ClassWithin = ParentClass->ClassWithin;
-			Class->ClassConfigName = ParentClass->ClassConfigName;
+		StartStreamingTicker();
+	}
 
-			Class->SetSuperStruct(ParentClass);
-			Class->ClassFlags |= (ParentClass->ClassFlags & (CLASS_Inherit | CLASS_ScriptInherit | CLASS_CompiledFromBlueprint));
-			Class->ClassCastFlags |= ParentClass->ClassCastFlags;
+	void StartStreamingTicker()
+	{
+		if (!StreamingTickHandle.IsValid())
+		{
+			StreamingTickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FJavascriptContextImplementation::HandleStreamingTicker));
+		}
+	}
 
-			auto AddFunction = [&](FName NewFunctionName, Handle<Value> TheFunction) -> bool {
-				UFunction* ParentFunction = ParentClass->FindFunctionByName(NewFunctionName);
+	bool HandleStreamingTicker(float DeltaTime)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		HandleScope handle_scope(isolate());
+		Context::Scope context_scope(context());
 
-				UJavascriptGeneratedFunction* Function{ nullptr };
+		for (int32 Index = 0; Index < StreamingCompiles.Num();)
+		{
+			if (!StreamingCompiles[Index]->Event->IsComplete())
+			{
+				++Index;
+				continue;
+			}
 
-				auto MakeFunction = [&]() {
-					Function = NewObject<UJavascriptGeneratedFunction>(Class, NewFunctionName, RF_Public);
-					Function->JavascriptContext = Context->AsShared();
-					Function->RepOffset = MAX_uint16;
-					Function->ReturnValueOffset = MAX_uint16;
-					Function->FirstPropertyToInit = NULL;
+			// Running the module may start more compiles
+			auto Job = MoveTemp(StreamingCompiles[Index]);
+			StreamingCompiles.RemoveAt(Index);
 
-					Function->Script.Add(EX_EndFunctionParms);
-				};
+			FinishStreamingCompile(*Job);
+		}
+
+		for (int32 Index = 0; Index < JsonParses.Num();)
+		{
+			if (!JsonParses[Index]->Event->IsComplete())
+			{
+				++Index;
+				continue;
+			}
+
+			auto Job = MoveTemp(JsonParses[Index]);
+			JsonParses.RemoveAt(Index);
+
+			FinishJsonParse(*Job);
+		}
+
+		// Continuations run now rather than whenever script is entered next time
+		isolate()->RunMicrotasks();
+
+		if (StreamingCompiles.Num() == 0 && JsonParses.Num() == 0)
+		{
+			StreamingTickHandle.Reset();
+			return false;
+		}
+		return true;
+	}
+
+	void FinishStreamingCompile(FStreamingCompile& Job)
+	{
+		HandleScope handle_scope(isolate());
+		auto context = this->context();
+
+		auto Resolver = Local<Promise::Resolver>::New(isolate(), Job.Resolver);
+
+		auto Reject = [&](Local<Value> Reason)
+		{
+			if (Resolver.IsEmpty())
+			{
+				UE_LOG(Javascript, Warning, TEXT("Failed to preload %s"), *Job.FullPath);
+			}
+			else
+			{
+				(void)Resolver->Reject(context, Reason);
+			}
+		};
+
+		if (!Job.bLoaded)
+		{
+			Reject(Exception::Error(V8_String(isolate(), FString::Printf(TEXT("Cannot load module %s"), *Job.FullPath))));
+			return;
+		}
+
+		TryCatch try_catch;
+
+		ScriptOrigin origin(V8_String(isolate(), GetScriptURL(Job.FullPath)));
+		Local<Script> script;
+		if (!ScriptCompiler::Compile(context, &Job.Source, V8_String(isolate(), Job.Text), origin).ToLocal(&script))
+		{
+			UncaughtException(FV8Exception::Report(try_catch));
+			Reject(try_catch.Exception());
+			return;
+		}
+
+		// A synchronous require may have loaded the module meanwhile
+		if (Resolver.IsEmpty())
+		{
+			if (!Modules.Contains(Job.FullPath))
+			{
+				PreloadedScripts.Add(Job.FullPath, v8::Global<Script>(isolate(), script));
+			}
+			return;
+		}
+
+		Local<Value> moduleExports;
+		if (auto it = Modules.Find(Job.FullPath))
+		{
+			moduleExports = Local<Value>::New(isolate(), *it);
+		}
+		else
+		{
+			moduleExports = RunCompiledScript(script);
+			Modules.Add(Job.FullPath, v8::Global<Value>(isolate(), moduleExports));
+		}
+
+		if (moduleExports.IsEmpty())
+		{
+			Reject(Exception::Error(V8_String(isolate(), FString::Printf(TEXT("Invalid script %s"), *Job.FullPath))));
+		}
+		else
+		{
+			(void)Resolver->Resolve(context, moduleExports);
+		}
+	}
+
+	void FinishJsonParse(FJsonParseJob& Job)
+	{
+		HandleScope handle_scope(isolate());
+		auto context = this->context();
+
+		auto Resolver = Local<Promise::Resolver>::New(isolate(), Job.Resolver);
+
+		// A synchronous require may have loaded the module meanwhile
+		if (auto it = Job.ModulePath.IsEmpty() ? nullptr : Modules.Find(Job.ModulePath))
+		{
+			(void)Resolver->Resolve(context, Local<Value>::New(isolate(), *it));
+			return;
+		}
+
+		TryCatch try_catch;
+
+		Local<Value> value;
+		if (!Job.Parse(context).ToLocal(&value))
+		{
+			(void)Resolver->Reject(context, try_catch.Exception());
+			return;
+		}
+
+		if (!Job.ModulePath.IsEmpty())
+		{
+			Modules.Add(Job.ModulePath, v8::Global<Value>(isolate(), value));
+		}
+		(void)Resolver->Resolve(context, value);
+	}
+
+	/** Waits for background parsing, which must not outlive the isolate; pending promises never settle */
+	void CancelStreamingCompiles()
+	{
+		for (const auto& Job : StreamingCompiles)
+		{
+			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Job->Event);
+		}
+		StreamingCompiles.Empty();
+
+		for (const auto& Job : JsonParses)
+		{
+			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Job->Event);
+		}
+		JsonParses.Empty();
+
+		if (StreamingTickHandle.IsValid())
+		{
+			FTicker::GetCoreTicker().RemoveTicker(StreamingTickHandle);
+			StreamingTickHandle.Reset();
+		}
+	}
+
+	/**
+	* Expose the CreateClass function in the global V8 scope.
+	*/
+	void ExposeCreateClass()
+	{
+		auto fn = [](const FunctionCallbackInfo<Value>& info) {
+			auto Context = reinterpret_cast<FJavascriptContextImplementation*>((Local<External>::Cast(info.Data()))->Value());
+
+			auto isolate = info.GetIsolate();
+
+			FIsolateHelper I(isolate);
+
+			HandleScope scope(isolate);
+
+			auto Name = StringFromV8(info[0]);
+			auto Opts = info[1]->ToObject();
+			auto Outer = UObjectFromV8(Opts->Get(I.Keyword("Outer")));
+			auto ParentClass = UClassFromV8(isolate, Opts->Get(I.Keyword("Parent")));
+			Outer = Outer ? Outer : GetTransientPackage();
+			ParentClass = ParentClass ? ParentClass : UObject::StaticClass();
+
+			UBlueprintGeneratedClass* Class = nullptr;
+			if (Cast<UBlueprintGeneratedClass>(ParentClass))
+			{
+				auto Klass = NewObject<UJavascriptGeneratedClass>(Outer, *Name, RF_Public);
+				Klass->JavascriptContext = Context->AsShared();
+				Class = Klass;
+			}
+			else
+			{
+				auto Klass = NewObject<UJavascriptGeneratedClass_Native>(Outer, *Name, RF_Public);
+				Klass->JavascriptContext = Context->AsShared();
+				Class = Klass;
+
+				// This flag is necessary for proper initialization
+				Class->ClassFlags |= CLASS_Native;
+			}
+
+			// Create a blueprint
+			auto Blueprint = NewObject<UBlueprint>(Outer);
+			Blueprint->GeneratedClass = Class;
+			Class->ClassGeneratedBy = Blueprint;
+
+			auto ClassConstructor = [](const FObjectInitializer& ObjectInitializer){
+				auto Class = static_cast<UBlueprintGeneratedClass*>(CurrentClassUnderConstruction ? CurrentClassUnderConstruction : ObjectInitializer.GetClass());
+				CurrentClassUnderConstruction = nullptr;
+
+				FJavascriptContextImplementation* Context = nullptr;
+
+				if (auto Klass = Cast<UJavascriptGeneratedClass_Native>(Class))
+				{
+					if (Klass->JavascriptContext.IsValid())
+					{
+						Context = static_cast<FJavascriptContextImplementation*>(Klass->JavascriptContext.Pin().Get());
+					}
+				}
+				else if (auto Klass = Cast<UJavascriptGeneratedClass>(Class))
+				{
+					if (Klass->JavascriptContext.IsValid())
+					{
+						Context = static_cast<FJavascriptContextImplementation*>(Klass->JavascriptContext.Pin().Get());
+					}
+				}
+
+				if (Context)
+				{
+					auto isolate = Context->isolate();
+					auto Object = ObjectInitializer.GetObj();
+
+					FIsolateHelper I(isolate);
+
+					Isolate::Scope isolate_scope(isolate);
+					HandleScope handle_scope(isolate);
+					Context::Scope context_scope(Context->context());
+
+					auto Table = Context->ProxyFunctionTables.Find(Class);
+					if (!Table)
+					{
+						I.Throw(TEXT("Invalid proxy : construct class"));
+						return;
+					}
+
+					Context->ObjectInitializerStack.Add(&ObjectInitializer);
+
+					auto This = Context->ExportObject(Object);
+
+					auto context = Context->context();
+
+					if (!Table->PreConstructor.IsEmpty())
+					{
+						CallJavascriptFunction(context, This, nullptr, Local<Function>::New(isolate, Table->PreConstructor), nullptr);
+					}
+
+					CallClassConstructor(Class->GetSuperClass(), ObjectInitializer);
+
+					// Table may have been relocated while constructing the super class
+					Table = Context->ProxyFunctionTables.Find(Class);
+					if (Table && !Table->Constructor.IsEmpty())
+					{
+						CallJavascriptFunction(context, This, nullptr, Local<Function>::New(isolate, Table->Constructor), nullptr);
+					}
+
+					Context->ObjectInitializerStack.RemoveAt(Context->ObjectInitializerStack.Num() - 1, 1);
+				}
+				else
+				{
+					CallClassConstructor(Class->GetSuperClass(), ObjectInitializer);
+				}
+			};
+
+			Class->ClassConstructor = ClassConstructor;
+
+			// Set properties we need to regenerate the class with
+			Class->PropertyLink = ParentClass->PropertyLink;
+			Class->ClassWithin = ParentClass->ClassWithin;
+			Class->ClassConfigName = ParentClass->ClassConfigName;
+
+			Class->SetSuperStruct(ParentClass);
+			Class->ClassFlags |= (ParentClass->ClassFlags & (CLASS_Inherit | CLASS_ScriptInherit | CLASS_CompiledFromBlueprint));
+			Class->ClassCastFlags |= ParentClass->ClassCastFlags;
+
+			auto AddFunction = [&](FName NewFunctionName, Handle<Value> TheFunction) -> UFunction* {
+				UFunction* ParentFunction = ParentClass->FindFunctionByName(NewFunctionName);
+
+				UJavascriptGeneratedFunction* Function{ nullptr };
+
+				auto MakeFunction = [&]() {
+					Function = NewObject<UJavascriptGeneratedFunction>(Class, NewFunctionName, RF_Public);
+					Function->JavascriptContext = Context->AsShared();
+					Function->RepOffset = MAX_uint16;
+					Function->ReturnValueOffset = MAX_uint16;
+					Function->FirstPropertyToInit = NULL;
+
+					Function->Script.Add(EX_EndFunctionParms);
+				};
 
 				// Overridden function should have its parent function
 				if (ParentFunction)
@@ -1059,7 +1591,7 @@ public:
 					auto IsUFUNCTION = FunctionObj->Get(I.Keyword("IsUFUNCTION"));
 					if (IsUFUNCTION.IsEmpty() || !IsUFUNCTION->BooleanValue())
 					{
-						return false;
+						return nullptr;
 					}
 
 					MakeFunction();
@@ -1104,7 +1636,7 @@ public:
 					InitializeProperties(Function, Signature);
 				}
 
-				auto FinalizeFunction = [](UFunction* Function) {
+				auto FinalizeFunction = [](UJavascriptGeneratedFunction* Function) {
 					Function->Bind();
 					Function->StaticLink(true);
 
@@ -1144,6 +1676,42 @@ public:
 							}
 						}
 					}
+
+					// Cache what the thunk needs to know about parameters
+					bool bHasAnyOutParams = false;
+					Function->bFrameNeedsZeroing = false;
+					Function->OutParmsToCopy.Reset();
+					for (TFieldIterator<UProperty> PropIt(Function, EFieldIteratorFlags::ExcludeSuper); PropIt && PropIt->HasAnyPropertyFlags(CPF_Parm); ++PropIt)
+					{
+						UProperty* Property = *PropIt;
+						if (Property->HasAnyPropertyFlags(CPF_ReturnParm))
+						{
+							Function->ReturnParam = Property;
+						}
+						else if ((Property->PropertyFlags & (CPF_ConstParm | CPF_OutParm)) == CPF_OutParm)
+						{
+							bHasAnyOutParams = true;
+						}
+
+						// Return value and out parms aren't initialized while evaluating arguments
+						if (Property->HasAnyPropertyFlags(CPF_OutParm))
+						{
+							Function->bFrameNeedsZeroing = true;
+							Function->OutParmsToCopy.Add((Property->PropertyFlags & (CPF_ConstParm | CPF_OutParm)) == CPF_OutParm);
+						}
+					}
+
+					if (!bHasAnyOutParams)
+					{
+						Function->OutParmsToCopy.Empty();
+					}
+					else
+					{
+						while (!Function->OutParmsToCopy.Last())
+						{
+							Function->OutParmsToCopy.Pop(false);
+						}
+					}
 				};
 
 				FinalizeFunction(Function);
@@ -1156,7 +1724,7 @@ public:
 				// Add the function to it's owner class function name -> function map
 				Class->AddFunctionToFunctionMap(Function);
 
-				return true;
+				return Function;
 			};
 
 			auto ClassFlags = Opts->Get(I.Keyword("ClassFlags"));
@@ -1193,6 +1761,7 @@ public:
 
 			auto Functions = Opts->Get(I.Keyword("Functions"));
 			TMap<FString,Handle<Value>> Others;
+			FProxyFunctionTable ProxyFunctionTable;
 			if (!Functions.IsEmpty() && Functions->IsObject())
 			{
 				auto FuncMap = Functions->ToObject();
@@ -1208,9 +1777,21 @@ public:
 
 					if (!Function->IsFunction()) continue;
 
-					if (UName != TEXT("prector") && UName != TEXT("ctor") && UName != TEXT("constructor"))
+					if (UName == TEXT("prector"))
+					{
+						ProxyFunctionTable.PreConstructor.Reset(isolate, Function.As<v8::Function>());
+					}
+					else if (UName == TEXT("ctor"))
 					{
-						if (!AddFunction(*UName, Function))
+						ProxyFunctionTable.Constructor.Reset(isolate, Function.As<v8::Function>());
+					}
+					else if (UName != TEXT("constructor"))
+					{
+						if (auto NewFunction = AddFunction(*UName, Function))
+						{
+							ProxyFunctionTable.Functions.Add(NewFunction, v8::Global<v8::Function>(isolate, Function.As<v8::Function>()));
+						}
+						else
 						{
 							Others.Add(UName, Function);
 						}
@@ -1236,6 +1817,33 @@ public:
 			auto FinalClass = Context->ExportObject(Class);
 			FinalClass->ToObject()->Set(I.Keyword("proxy"), Functions);
 
+			// Replaces the table of a previous definition of this class
+			if (!Functions.IsEmpty() && Functions->IsObject())
+			{
+				// Functions inherited from generated super classes are copied in, so that one lookup covers the hierarchy;
+				// the nearest table has its own inherited ones already
+				for (auto Super = Class->GetSuperClass(); Super; Super = Super->GetSuperClass())
+				{
+					if (auto SuperTable = Context->ProxyFunctionTables.Find(Super))
+					{
+						for (const auto& Pair : SuperTable->Functions)
+						{
+							if (!ProxyFunctionTable.Functions.Contains(Pair.Key))
+							{
+								ProxyFunctionTable.Functions.Add(Pair.Key, v8::Global<v8::Function>(isolate, Local<Function>::New(isolate, Pair.Value)));
+							}
+						}
+						break;
+					}
+				}
+
+				Context->ProxyFunctionTables.Add(Class, MoveTemp(ProxyFunctionTable));
+			}
+			else
+			{
+				Context->ProxyFunctionTables.Remove(Class);
+			}
+
 			info.GetReturnValue().Set(FinalClass);
 
 			// Make sure CDO is ready for use
@@ -1360,14 +1968,442 @@ public:
 		return v8::Undefined(isolate());
 	}
 
-	/**
-	 * Resolve a module filename to an actual file on disk.
-	 *
-	 * @param moduleFilename An absolute filename, relative filename, or name of the module to resolve.
-	 * @param currentScriptPath Directory relative to which a relative module filename will be resolved.
-	 * @return The absolute filename of the module, or an empty string (on failure).
+	/** Whether a watcher reports changes at Path, which then invalidate the resolution cache */
+	bool IsWatchedPath(const FString& Path) const
+	{
+#if V8_ENABLE_DIRECTORY_WATCHER
+		auto FullPath = FPaths::ConvertRelativePathToFull(Path);
+		for (const auto& Pair : WatchedDirectories)
+		{
+			if (FullPath.StartsWith(Pair.Key) && (FullPath.Len() == Pair.Key.Len() || FullPath[Pair.Key.Len()] == TEXT('/')))
+			{
+				return true;
+			}
+		}
+		return false;
+#else
+		// Nothing reports changes, so script files are taken to stay as they are
+		return true;
+#endif
+	}
+
+	/** Probes Path once with a single stat; later lookups come from the cache, negative ones only within watched directories */
+	EPathKind GetPathKind(const FString& Path)
+	{
+		if (auto Cached = PathKinds.Find(Path))
+		{
+			return *Cached;
+		}
+
+		if (FScriptArchive::FindFile(Path))
+		{
+			return PathKinds.Add(Path, EPathKind::File);
+		}
+		if (FScriptArchive::HasDirectory(Path))
+		{
+			return PathKinds.Add(Path, EPathKind::Directory);
+		}
+
+		auto Stat = IFileManager::Get().GetStatData(*Path);
+		auto Kind = !Stat.bIsValid ? EPathKind::Missing : (Stat.bIsDirectory ? EPathKind::Directory : EPathKind::File);
+		if (Kind != EPathKind::Missing || IsWatchedPath(Path))
+		{
+			PathKinds.Add(Path, Kind);
+		}
+		else
+		{
+			bUncachedProbe = true;
+		}
+		return Kind;
+	}
+
+	bool FileExists(const FString& Path)
+	{
+		return GetPathKind(Path) == EPathKind::File;
+	}
+
+	bool DirectoryExists(const FString& Path)
+	{
+		return GetPathKind(Path) == EPathKind::Directory;
+	}
+
+	/** "main" of the package.json in packagePath; empty when there is none */
+	FString GetPackageMain(const FString& packagePath)
+	{
+		if (auto Cached = PackageMains.Find(packagePath))
+		{
+			return *Cached;
+		}
+
+		const bool bUncachedBefore = bUncachedProbe;
+		bUncachedProbe = false;
+
+		FString main;
+
+		FString jsonText;
+		auto packageJsonPath = packagePath / TEXT("package.json");
+		if (FileExists(packageJsonPath) && FScriptArchive::LoadFileToString(jsonText, packageJsonPath))
+		{
+			HandleScope handle_scope(isolate());
+			auto context = this->context();
+			Context::Scope context_scope(context);
+
+			TryCatch try_catch;
+
+			Local<Value> json;
+			if (JSON::Parse(context, V8_String(isolate(), jsonText)).ToLocal(&json) && json->IsObject())
+			{
+				auto mainValue = json.As<Object>()->Get(V8_KeywordString(isolate(), "main"));
+				if (!mainValue.IsEmpty() && mainValue->IsString())
+				{
+					main = StringFromV8(mainValue);
+				}
+			}
+			else
+			{
+				UE_LOG(Javascript, Warning, TEXT("Invalid package.json: %s"), *packageJsonPath);
+			}
+		}
+
+		// A package.json missing from an unwatched directory may turn up later
+		if (!bUncachedProbe)
+		{
+			PackageMains.Add(packagePath, main);
+		}
+		bUncachedProbe |= bUncachedBefore;
+
+		return main;
+	}
+
+	/** Forgets every resolution and probe, after script files were added, removed or changed */
+	void InvalidateResolutionCache()
+	{
+		ResolvedModuleFilenames.Empty();
+		PackageMains.Empty();
+		PathKinds.Empty();
+	}
+
+	void WatchSearchPaths()
+	{
+		UnwatchSearchPaths();
+
+#if V8_ENABLE_DIRECTORY_WATCHER
+		auto DirectoryWatcher = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")).Get();
+		auto Changed = IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FJavascriptContextImplementation::OnScriptDirectoryChanged);
+
+		for (const auto& Path : Paths)
+		{
+			auto Directory = FPaths::ConvertRelativePathToFull(Path);
+			if (!IFileManager::Get().DirectoryExists(*Directory) || WatchedDirectories.Contains(Directory))
+			{
+				continue;
+			}
+
+			FDelegateHandle Handle;
+			if (DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(Directory, Changed, Handle, true))
+			{
+				WatchedDirectories.Add(Directory, Handle);
+			}
+		}
+#endif
+	}
+
+	void UnwatchSearchPaths()
+	{
+#if V8_ENABLE_DIRECTORY_WATCHER
+		auto DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+		if (DirectoryWatcherModule && DirectoryWatcherModule->Get())
+		{
+			for (const auto& Pair : WatchedDirectories)
+			{
+				DirectoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(Pair.Key, Pair.Value);
+			}
+		}
+		WatchedDirectories.Empty();
+#endif
+	}
+
+#if V8_ENABLE_DIRECTORY_WATCHER
+	void OnScriptDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
+	{
+		InvalidateResolutionCache();
+
+		// Editors often save by replacing the file, which shows up as an addition
+		TArray<FString> ChangedModules;
+		for (const auto& Change : FileChanges)
+		{
+			if (Change.Action == FFileChangeData::FCA_Modified || Change.Action == FFileChangeData::FCA_Added)
+			{
+				auto Key = GetModuleCacheKey(Change.Filename);
+				if (Modules.Contains(Key))
+				{
+					ChangedModules.AddUnique(Key);
+				}
+			}
+		}
+
+		if (ChangedModules.Num())
+		{
+			HotReload(ChangedModules);
+		}
+	}
+#endif
+
+	/**
+	* Reloads changed modules along with their importers, up to the nearest modules which accept the update.
+	* Where nothing accepts it, the modules on the way are only dropped from the cache, so that the next require picks the change up.
+	*/
+	void HotReload(const TArray<FString>& ChangedModules)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		HandleScope handle_scope(isolate());
+		Context::Scope context_scope(context());
+
+		TSet<FString> Outdated;
+		TArray<FString> SelfAccepted;
+		/** Importer and dependency */
+		TArray<TPair<FString, FString>> AcceptedByImporter;
+
+		auto Pending = ChangedModules;
+		while (Pending.Num())
+		{
+			auto Path = Pending.Pop(false);
+			if (Outdated.Contains(Path))
+			{
+				continue;
+			}
+			Outdated.Add(Path);
+
+			auto State = HotModules.Find(Path);
+			if (State && State->bSelfAccepted)
+			{
+				SelfAccepted.Add(Path);
+				continue;
+			}
+
+			auto Importers = ModuleImporters.Find(Path);
+			if (!Importers || Importers->Num() == 0)
+			{
+				UE_LOG(Javascript, Log, TEXT("Hot reload stops at %s, which does not accept updates; run it again to apply them"), *Path);
+				continue;
+			}
+
+			for (const auto& Importer : *Importers)
+			{
+				auto ImporterState = HotModules.Find(Importer);
+				if (ImporterState && ImporterState->AcceptedDependencies.Contains(Path))
+				{
+					AcceptedByImporter.AddUnique(TPair<FString, FString>(Importer, Path));
+				}
+				else
+				{
+					Pending.Add(Importer);
+				}
+			}
+		}
+
+		for (const auto& Path : Outdated)
+		{
+			if (auto State = HotModules.Find(Path))
+			{
+				auto data = Object::New(isolate());
+				for (const auto& Handler : State->DisposeHandlers)
+				{
+					CallHotHandler(Local<Function>::New(isolate(), Handler), data);
+				}
+				State->Data.Reset(isolate(), data);
+			}
+
+			Modules.Remove(Path);
+			PreloadedScripts.Remove(Path);
+			RemoveEsModule(Path);
+		}
+
+		UE_LOG(Javascript, Log, TEXT("Hot reload of %d module(s) invalidated %d"), ChangedModules.Num(), Outdated.Num());
+
+		for (const auto& Path : SelfAccepted)
+		{
+			LoadModule(Path);
+		}
+
+		for (const auto& Pair : AcceptedByImporter)
+		{
+			const auto& Dependency = Pair.Value;
+			auto exports = Dependency.EndsWith(TEXT(".json")) ? LoadJson(Dependency) : LoadModule(Dependency);
+
+			// Looked up only now, as reloading adds to HotModules
+			auto State = HotModules.Find(Pair.Key);
+			auto Handler = State ? State->AcceptedDependencies.Find(Dependency) : nullptr;
+			if (Handler && !Handler->IsEmpty() && !exports.IsEmpty())
+			{
+				CallHotHandler(Local<Function>::New(isolate(), *Handler), exports);
+			}
+		}
+	}
+
+	// Should be guarded with proper handle scope
+	void CallHotHandler(Local<Function> Handler, Local<Value> Argument)
+	{
+		TryCatch try_catch;
+		try_catch.SetVerbose(true);
+
+		if (Handler->Call(context(), context()->Global(), 1, &Argument).IsEmpty())
+		{
+			FJavascriptContext::FromV8(context())->UncaughtException(FV8Exception::Report(try_catch));
+		}
+	}
+
+	/** `module.hot` of a module which is being evaluated; it starts over with every evaluation */
+	Local<Object> CreateHotModule(const FString& fullPath)
+	{
+		auto& State = HotModules.FindOrAdd(fullPath);
+
+		Local<Value> data = Undefined(isolate());
+		if (!State.Data.IsEmpty())
+		{
+			data = Local<Object>::New(isolate(), State.Data);
+		}
+		State = FHotModule();
+
+		// What it requires now is recorded again as it runs
+		RemoveModuleImports(fullPath);
+
+		// The module is bound to the functions, which may be called with any receiver
+		auto binding = Array::New(isolate(), 2);
+		binding->Set(0, External::New(isolate(), this));
+		binding->Set(1, V8_String(isolate(), fullPath));
+
+		auto hot = Object::New(isolate());
+		hot->Set(V8_KeywordString(isolate(), "id"), V8_String(isolate(), fullPath));
+		hot->Set(V8_KeywordString(isolate(), "data"), data);
+		hot->Set(V8_KeywordString(isolate(), "accept"), Function::New(context(), HotAccept, binding).ToLocalChecked());
+		hot->Set(V8_KeywordString(isolate(), "dispose"), Function::New(context(), HotDispose, binding).ToLocalChecked());
+		return hot;
+	}
+
+	/** Forgets the modules importer has required */
+	void RemoveModuleImports(const FString& importer)
+	{
+		for (auto It = ModuleImporters.CreateIterator(); It; ++It)
+		{
+			It.Value().Remove(importer);
+			if (It.Value().Num() == 0)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	/** Context and module path which HotAccept and HotDispose are bound to */
+	static FJavascriptContextImplementation* GetHotBinding(const FunctionCallbackInfo<Value>& info, FString& OutPath)
+	{
+		auto binding = info.Data().As<Array>();
+		OutPath = StringFromV8(binding->Get(1));
+		return reinterpret_cast<FJavascriptContextImplementation*>(binding->Get(0).As<External>()->Value());
+	}
+
+	/** module.hot.accept() to be reloaded in place, or module.hot.accept(dependency[, handler]) to stay while the dependency is reloaded */
+	static void HotAccept(const FunctionCallbackInfo<Value>& info)
+	{
+		auto isolate = info.GetIsolate();
+		HandleScope scope(isolate);
+
+		FIsolateHelper I(isolate);
+
+		FString fullPath;
+		auto self = GetHotBinding(info, fullPath);
+
+		auto State = self->HotModules.Find(fullPath);
+		if (!State)
+		{
+			return;
+		}
+
+		if (info.Length() == 0)
+		{
+			State->bSelfAccepted = true;
+			return;
+		}
+
+		if (!info[0]->IsString() || (info.Length() > 1 && !info[1]->IsFunction()))
+		{
+			I.Throw(TEXT("module.hot.accept requires nothing, or a module name and an optional handler"));
+			return;
+		}
+
+		auto dependency = StringFromV8(info[0]);
+		auto resolvedModuleFilename = self->ResolveModuleFilename(dependency, FPaths::GetPath(fullPath));
+		if (resolvedModuleFilename.IsEmpty())
+		{
+			I.Throw(FString::Printf(TEXT("Cannot find module %s"), *dependency));
+			return;
+		}
+
+		auto& Handler = State->AcceptedDependencies.FindOrAdd(GetModuleCacheKey(resolvedModuleFilename));
+		if (info.Length() > 1)
+		{
+			Handler.Reset(isolate, info[1].As<Function>());
+		}
+	}
+
+	/** module.hot.dispose(handler), run with an object for the next instance before the module is reloaded */
+	static void HotDispose(const FunctionCallbackInfo<Value>& info)
+	{
+		auto isolate = info.GetIsolate();
+		HandleScope scope(isolate);
+
+		FIsolateHelper I(isolate);
+
+		if (info.Length() != 1 || !info[0]->IsFunction())
+		{
+			I.Throw(TEXT("module.hot.dispose requires a handler"));
+			return;
+		}
+
+		FString fullPath;
+		auto self = GetHotBinding(info, fullPath);
+
+		if (auto State = self->HotModules.Find(fullPath))
+		{
+			State->DisposeHandlers.Emplace(isolate, info[0].As<Function>());
+		}
+	}
+
+	/**
+	 * Resolve a module filename to an actual file on disk.
+	 * Results are cached by module filename and directory until script directories change.
+	 * Failures are cached only when every path they rest on is watched.
+	 *
+	 * @param moduleFilename An absolute filename, relative filename, or name of the module to resolve.
+	 * @param currentScriptPath Directory relative to which a relative module filename will be resolved.
+	 * @return The absolute filename of the module, or an empty string (on failure).
 	 */
 	FString ResolveModuleFilename(const FString& moduleFilename, const FString& currentScriptPath)
+	{
+		// Search paths may have been added or removed since
+		if (ResolvedSearchPaths != Paths)
+		{
+			ResolvedSearchPaths = Paths;
+			InvalidateResolutionCache();
+			WatchSearchPaths();
+		}
+
+		auto key = moduleFilename + TEXT("\n") + currentScriptPath;
+		if (auto cached = ResolvedModuleFilenames.Find(key))
+		{
+			return *cached;
+		}
+
+		bUncachedProbe = false;
+		auto resolvedFilename = ResolveModuleFilenameUncached(moduleFilename, currentScriptPath);
+		if (!resolvedFilename.IsEmpty() || !bUncachedProbe)
+		{
+			ResolvedModuleFilenames.Add(key, resolvedFilename);
+		}
+		return resolvedFilename;
+	}
+
+	FString ResolveModuleFilenameUncached(const FString& moduleFilename, const FString& currentScriptPath)
 	{
 		/**
 		 * Resolve the main module specified in a package.json to a file on disk.
@@ -1379,51 +2415,34 @@ public:
 		auto resolvePackageMainModule = [this](const FString& packagePath,
 											   FString& resolvedPath) -> bool
 		{
-			FString jsonText;
-			if (FFileHelper::LoadFileToString(jsonText, *(packagePath / TEXT("package.json"))))
+			const auto& mainModuleFilename = this->GetPackageMain(packagePath);
+			if (!mainModuleFilename.IsEmpty())
 			{
-				jsonText = FString::Printf(TEXT("(function (json) {return json.main;})(%s);"), *jsonText);
-				auto fullPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*packagePath);
-#if PLATFORM_WINDOWS
-				fullPath = fullPath.Replace(TEXT("/"), TEXT("\\"));
-#endif
-				auto mainModuleFilename = this->RunScript(fullPath, jsonText, 0);
-				if (mainModuleFilename->IsString())
+				auto candidatePath = packagePath / mainModuleFilename;
+				if (!candidatePath.EndsWith(TEXT(".js")))
 				{
-					auto candidatePath = packagePath / StringFromV8(mainModuleFilename);
-					if (candidatePath.EndsWith(TEXT(".js")))
-					{
-						if (FPaths::FileExists(candidatePath))
-						{
-							resolvedPath = candidatePath;
-							return true;
-						}
-					}
-					else
-					{
-						candidatePath += TEXT(".js");
-						if (FPaths::FileExists(candidatePath))
-						{
-							resolvedPath = candidatePath;
-							return true;
-						}
-					}
+					candidatePath += TEXT(".js");
+				}
+				if (this->FileExists(candidatePath))
+				{
+					resolvedPath = candidatePath;
+					return true;
 				}
 			}
 			return false;
 		};
 
-		auto resolveModule = [&resolvePackageMainModule](const FString& basePath,
-														 const FString& requiredModule,
-														 FString& resolvedPath) -> bool
+		auto resolveModule = [this, &resolvePackageMainModule](const FString& basePath,
+															   const FString& requiredModule,
+															   FString& resolvedPath) -> bool
 		{
-			if (!basePath.IsEmpty() && !FPaths::DirectoryExists(basePath))
+			if (!basePath.IsEmpty() && !this->DirectoryExists(basePath))
 				return false;
 
 			auto candidatePath = basePath.IsEmpty() ? requiredModule : (basePath / requiredModule);
-			if (candidatePath.EndsWith(TEXT(".js")) || candidatePath.EndsWith(TEXT(".json")))
+			if (candidatePath.EndsWith(TEXT(".js")) || candidatePath.EndsWith(TEXT(".mjs")) || candidatePath.EndsWith(TEXT(".json")))
 			{
-				if (FPaths::FileExists(candidatePath))
+				if (this->FileExists(candidatePath))
 				{
 					resolvedPath = candidatePath;
 					return true;
@@ -1432,28 +2451,28 @@ public:
 			}
 
 			candidatePath = (basePath.IsEmpty() ? requiredModule : (basePath / requiredModule)) + TEXT(".js");
-			if (FPaths::FileExists(candidatePath))
+			if (this->FileExists(candidatePath))
 			{
 				resolvedPath = candidatePath;
 				return true;
 			}
 
 			candidatePath = (basePath.IsEmpty() ? requiredModule : (basePath / requiredModule)) + TEXT(".json");
-			if (FPaths::FileExists(candidatePath))
+			if (this->FileExists(candidatePath))
 			{
 				resolvedPath = candidatePath;
 				return true;
 			}
 
 			candidatePath = (basePath.IsEmpty() ? requiredModule : (basePath / requiredModule)) / TEXT("index.js");
-			if (FPaths::FileExists(candidatePath))
+			if (this->FileExists(candidatePath))
 			{
 				resolvedPath = candidatePath;
 				return true;
 			}
 
 			candidatePath = basePath.IsEmpty() ? requiredModule : (basePath / requiredModule);
-			return resolvePackageMainModule(candidatePath, resolvedPath);
+			return this->DirectoryExists(candidatePath) && resolvePackageMainModule(candidatePath, resolvedPath);
 		};
 
 		auto load_module_paths = [](const FString& base_path)
@@ -1512,7 +2531,132 @@ public:
 		return TEXT("");
 	}
 
-	/** Expose `require`, `purgeModules`, and `modules` in the global V8 scope. */
+	/** Absolute path by which a module is cached */
+	static FString GetModuleCacheKey(const FString& modulePath)
+	{
+		auto fullPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*modulePath);
+#if PLATFORM_WINDOWS
+		fullPath = fullPath.Replace(TEXT("/"), TEXT("\\"));
+#endif
+		return fullPath;
+	}
+
+	/** Runs a module unless it is cached; returns an empty handle when it cannot be loaded */
+	Local<Value> LoadModule(const FString& fullPath)
+	{
+		// grab the module from the cache if possible
+		auto it = Modules.Find(fullPath);
+		if (it)
+		{
+			return Local<Value>::New(isolate(), *it);
+		}
+
+		Local<Value> moduleExports;
+
+		// compiled in the background already
+		auto preloaded = PreloadedScripts.Find(fullPath);
+		if (preloaded)
+		{
+			auto script = Local<Script>::New(isolate(), *preloaded);
+			PreloadedScripts.Remove(fullPath);
+			moduleExports = RunCompiledScript(script);
+		}
+		else if (auto archived = FScriptArchive::FindFile(fullPath))
+		{
+			// wrapped without copying the source out of the archive
+			auto source = String::Concat(
+				String::Concat(V8_String(isolate(), ModuleSourcePrefix), FScriptArchive::GetString(isolate(), *archived)),
+				V8_String(isolate(), GetModuleSourceSuffix(fullPath)));
+			auto key = FString::Printf(TEXT("%s-%08x"), *BytesToHex(archived->Hash.Hash, sizeof(archived->Hash.Hash)), FCrc::StrCrc32(*fullPath));
+			auto script = CompileArchivedScript(fullPath, key, source, *archived);
+			if (!script.IsEmpty())
+			{
+				moduleExports = RunCompiledScript(script);
+			}
+		}
+		else
+		{
+			// module isn't in the cache so load it from disk and cache it
+			FString code;
+			if (!FFileHelper::LoadFileToString(code, *fullPath))
+			{
+				return Local<Value>();
+			}
+			auto script = CompileScriptFile(fullPath, WrapModuleSource(code, fullPath));
+			if (!script.IsEmpty())
+			{
+				moduleExports = RunCompiledScript(script);
+			}
+		}
+
+		if (moduleExports.IsEmpty())
+		{
+			UE_LOG(Javascript, Log, TEXT("Invalid script for require"));
+		}
+		Modules.Add(fullPath, v8::Global<Value>(isolate(), moduleExports));
+		return moduleExports;
+	}
+
+	/** Parses a JSON module unless it is cached; returns an empty handle when it cannot be loaded */
+	Local<Value> LoadJson(const FString& fullPath)
+	{
+		auto it = Modules.Find(fullPath);
+		if (it)
+		{
+			return Local<Value>::New(isolate(), *it);
+		}
+
+		// Straight to V8's JSON parser rather than compiling the text as script
+		FJsonParseJob Job;
+		Job.Filename = fullPath;
+		if (!Job.Load())
+		{
+			return Local<Value>();
+		}
+
+		TryCatch try_catch;
+		try_catch.SetVerbose(true);
+
+		Local<Value> json;
+		if (!Job.Parse(context()).ToLocal(&json))
+		{
+			UE_LOG(Javascript, Warning, TEXT("Invalid JSON: %s"), *fullPath);
+			FJavascriptContext::FromV8(context())->UncaughtException(FV8Exception::Report(try_catch));
+			return Local<Value>();
+		}
+
+		Modules.Add(fullPath, v8::Global<Value>(isolate(), json));
+		return json;
+	}
+
+	/** Script which is calling into native code */
+	static FString GetCurrentScriptFilename(Isolate* isolate)
+	{
+		auto trace = StackTrace::CurrentStackTrace(isolate, 1, StackTrace::kScriptName);
+		if (trace->GetFrameCount() == 0)
+		{
+			return FString();
+		}
+		return URLToLocalPath(StringFromV8(trace->GetFrame(0)->GetScriptName()));
+	}
+
+	/** Directory of the script which is calling into native code */
+	static FString GetCurrentScriptPath(Isolate* isolate)
+	{
+		return FPaths::GetPath(GetCurrentScriptFilename(isolate));
+	}
+
+	/** Records that the calling script required fullPath, for hot reload to follow */
+	void AddModuleImporter(const FString& fullPath)
+	{
+		auto importer = GetCurrentScriptFilename(isolate());
+		if (!importer.IsEmpty())
+		{
+			ModuleImporters.FindOrAdd(fullPath).Add(GetModuleCacheKey(importer));
+		}
+	}
+
+	/** Expose `require`, `requireAsync`, `parseJsonAsync`, `purgeModules`, and `modules` in the global V8 scope. */
 	void ExposeRequire()
 	{
 		auto RequireWrapper = [](const FunctionCallbackInfo<Value>& info)
@@ -1527,100 +2671,150 @@ public:
 
 			auto self = reinterpret_cast<FJavascriptContextImplementation*>((Local<External>::Cast(info.Data()))->Value());
 
-			auto loadModule = [&self, &info, &isolate](const FString& modulePath) -> bool
+			auto currentScriptPath = GetCurrentScriptPath(isolate);
+
+			FString requiredModule = StringFromV8(info[0]);
+			FString nativeModulePrefix(TEXT("jsue/"));
+			if (requiredModule.StartsWith(nativeModulePrefix, ESearchCase::CaseSensitive))
 			{
-				auto fullPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*modulePath);
-#if PLATFORM_WINDOWS
-				fullPath = fullPath.Replace(TEXT("/"), TEXT("\\"));
-#endif
-				// grab the module from the cache if possible
-				auto it = self->Modules.Find(fullPath);
-				if (it)
+				auto nativeModule = self->LoadNativeModule(requiredModule.RightChop(nativeModulePrefix.Len()));
+				info.GetReturnValue().Set(nativeModule);
+				return;
+			}
+			else
+			{
+				FString resolvedModuleFilename = self->ResolveModuleFilename(requiredModule, currentScriptPath);
+				if (!resolvedModuleFilename.IsEmpty())
 				{
-					info.GetReturnValue().Set(Local<Value>::New(isolate, *it));
-					return true;
-				}
+					auto fullPath = GetModuleCacheKey(resolvedModuleFilename);
+					self->AddModuleImporter(fullPath);
 
-				// module isn't in the cache so load it from disk and cache it
-				FString code;
-				if (FFileHelper::LoadFileToString(code, *fullPath))
-				{
-					auto scriptDir = FPaths::GetPath(fullPath);
-					code = FString::Printf(
-						TEXT("(function (global, __filename, __dirname) {"
-							 "  var module = { exports: {}, filename : __filename }, exports = module.exports;"
-							 "  (function() { %s\n})();\n"
-							 "  return module.exports;\n"
-							 "}(this, '%s', '%s'));"),
-						*code, *fullPath, *scriptDir
-					);
-					auto moduleExports = self->RunScript(fullPath, code, 0);
-					if (moduleExports.IsEmpty())
+					Local<Value> moduleExports;
+					if (resolvedModuleFilename.EndsWith(TEXT(".js")))
 					{
-						UE_LOG(Javascript, Log, TEXT("Invalid script for require"));
+						moduleExports = self->LoadModule(fullPath);
+					}
+					else if (resolvedModuleFilename.EndsWith(TEXT(".json")))
+					{
+						moduleExports = self->LoadJson(fullPath);
 					}
-					self->Modules.Add(fullPath, v8::Global<Value>(isolate, moduleExports));
-					info.GetReturnValue().Set(moduleExports);
-					return true;
-				}
-
-				return false;
-			};
-
-			auto loadJson = [&self, &info, &isolate](const FString& jsonPath) -> bool
-			{
-				auto fullPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*jsonPath);
-#if PLATFORM_WINDOWS
-				fullPath = fullPath.Replace(TEXT("/"), TEXT("\\"));
-#endif
-				auto it = self->Modules.Find(fullPath);
-				if (it)
-				{
-					info.GetReturnValue().Set(Local<Value>::New(isolate, *it));
-					return true;
-				}
 
-				FString jsonText;
-				if (FFileHelper::LoadFileToString(jsonText, *fullPath))
-				{
-					jsonText = FString::Printf(TEXT("(function (json) {return json;})(%s);"), *jsonText);
-					auto jsonObject = self->RunScript(fullPath, jsonText, 0);
-					if (jsonObject->IsObject())
+					if (!moduleExports.IsEmpty())
 					{
-						self->Modules.Add(fullPath, v8::Global<Value>(isolate, jsonObject));
-						info.GetReturnValue().Set(jsonObject);
-						return true;
+						info.GetReturnValue().Set(moduleExports);
+						return;
 					}
 				}
+			}
+			info.GetReturnValue().Set(v8::Undefined(isolate));
+		};
 
-				return false;
-			};
+		// Like require, but reading and parsing of script modules happen on a background thread
+		auto RequireAsyncWrapper = [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto isolate = info.GetIsolate();
+			HandleScope scope(isolate);
+
+			auto self = reinterpret_cast<FJavascriptContextImplementation*>((Local<External>::Cast(info.Data()))->Value());
+			auto context = self->context();
 
-			auto currentScriptPath = StringFromV8(
-				StackTrace::CurrentStackTrace(isolate, 1, StackTrace::kScriptName)->GetFrame(0)->GetScriptName()
-			);
-			currentScriptPath = FPaths::GetPath(URLToLocalPath(currentScriptPath));
+			auto Resolver = Promise::Resolver::New(context).ToLocalChecked();
+			info.GetReturnValue().Set(Resolver->GetPromise());
+
+			if (info.Length() != 1 || !(info[0]->IsString()))
+			{
+				(void)Resolver->Reject(context, Exception::TypeError(V8_String(isolate, "requireAsync requires a module name")));
+				return;
+			}
 
 			FString requiredModule = StringFromV8(info[0]);
 			FString nativeModulePrefix(TEXT("jsue/"));
 			if (requiredModule.StartsWith(nativeModulePrefix, ESearchCase::CaseSensitive))
 			{
-				auto nativeModule = self->LoadNativeModule(requiredModule.RightChop(nativeModulePrefix.Len()));
-				info.GetReturnValue().Set(nativeModule);
-				return;
+				(void)Resolver->Resolve(context, self->LoadNativeModule(requiredModule.RightChop(nativeModulePrefix.Len())));
+				return;
+			}
+
+			FString resolvedModuleFilename = self->ResolveModuleFilename(requiredModule, GetCurrentScriptPath(isolate));
+			auto fullPath = GetModuleCacheKey(resolvedModuleFilename);
+			if (!resolvedModuleFilename.IsEmpty())
+			{
+				self->AddModuleImporter(fullPath);
+			}
+
+			if (resolvedModuleFilename.EndsWith(TEXT(".js")) && !self->Modules.Contains(fullPath) && !self->PreloadedScripts.Contains(fullPath))
+			{
+				self->StartStreamingCompile(fullPath)->Resolver.Reset(isolate, Resolver);
+				return;
+			}
+
+			if (resolvedModuleFilename.EndsWith(TEXT(".json")) && !self->Modules.Contains(fullPath))
+			{
+				auto Job = MakeUnique<FJsonParseJob>();
+				Job->Filename = fullPath;
+				Job->ModulePath = fullPath;
+				self->StartJsonParse(MoveTemp(Job), Resolver);
+				return;
+			}
+
+			// Cached or preloaded; nothing left worth a background thread
+			Local<Value> moduleExports;
+			if (resolvedModuleFilename.EndsWith(TEXT(".js")))
+			{
+				moduleExports = self->LoadModule(fullPath);
+			}
+			else if (resolvedModuleFilename.EndsWith(TEXT(".json")))
+			{
+				moduleExports = self->LoadJson(fullPath);
+			}
+
+			if (moduleExports.IsEmpty())
+			{
+				(void)Resolver->Reject(context, Exception::Error(V8_String(isolate, FString::Printf(TEXT("Cannot load module %s"), *requiredModule))));
+			}
+			else
+			{
+				(void)Resolver->Resolve(context, moduleExports);
+			}
+		};
+
+		// Like JSON.parse of a string or of UTF-8 bytes, with everything but building the value on a background thread
+		auto ParseJsonAsyncWrapper = [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto isolate = info.GetIsolate();
+			HandleScope scope(isolate);
+
+			auto self = reinterpret_cast<FJavascriptContextImplementation*>((Local<External>::Cast(info.Data()))->Value());
+			auto context = self->context();
+
+			auto Resolver = Promise::Resolver::New(context).ToLocalChecked();
+			info.GetReturnValue().Set(Resolver->GetPromise());
+
+			auto Job = MakeUnique<FJsonParseJob>();
+			if (info.Length() == 1 && info[0]->IsString())
+			{
+				auto text = info[0].As<String>();
+				Job->Utf8.AddUninitialized(text->Utf8Length());
+				text->WriteUtf8(reinterpret_cast<char*>(Job->Utf8.GetData()), Job->Utf8.Num(), nullptr, String::NO_NULL_TERMINATION);
+			}
+			else if (info.Length() == 1 && info[0]->IsArrayBufferView())
+			{
+				auto view = info[0].As<ArrayBufferView>();
+				auto contents = view->Buffer()->GetContents();
+				Job->Utf8.Append(static_cast<uint8*>(contents.Data()) + view->ByteOffset(), view->ByteLength());
+			}
+			else if (info.Length() == 1 && info[0]->IsArrayBuffer())
+			{
+				auto contents = info[0].As<ArrayBuffer>()->GetContents();
+				Job->Utf8.Append(static_cast<uint8*>(contents.Data()), contents.ByteLength());
 			}
 			else
 			{
-				FString resolvedModuleFilename = self->ResolveModuleFilename(requiredModule, currentScriptPath);
-				if (!resolvedModuleFilename.IsEmpty())
-				{
-					if (resolvedModuleFilename.EndsWith(TEXT(".js")) && loadModule(resolvedModuleFilename))
-						return;
-					if (resolvedModuleFilename.EndsWith(TEXT(".json")) && loadJson(resolvedModuleFilename))
-						return;
-				}
+				(void)Resolver->Reject(context, Exception::TypeError(V8_String(isolate, "parseJsonAsync requires a string or UTF-8 bytes")));
+				return;
 			}
-			info.GetReturnValue().Set(v8::Undefined(isolate));
+
+			self->StartJsonParse(MoveTemp(Job), Resolver);
 		};
 
 		auto fn2 = [](const FunctionCallbackInfo<Value>& info) {
@@ -1634,7 +2828,27 @@ public:
 		auto global = context()->Global();
 		auto self = External::New(isolate(), this);
 
-		global->Set(V8_KeywordString(isolate(), "require"), FunctionTemplate::New(isolate(), RequireWrapper, self)->GetFunction());
+		// require.hot(filename) is what the module wrapper passes in as module.hot
+		auto HotWrapper = [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto isolate = info.GetIsolate();
+			HandleScope scope(isolate);
+
+			if (info.Length() != 1 || !(info[0]->IsString()))
+			{
+				return;
+			}
+
+			auto self = reinterpret_cast<FJavascriptContextImplementation*>((Local<External>::Cast(info.Data()))->Value());
+			info.GetReturnValue().Set(self->CreateHotModule(StringFromV8(info[0])));
+		};
+
+		auto require = FunctionTemplate::New(isolate(), RequireWrapper, self)->GetFunction();
+		require->Set(V8_KeywordString(isolate(), "hot"), FunctionTemplate::New(isolate(), HotWrapper, self)->GetFunction());
+
+		global->Set(V8_KeywordString(isolate(), "require"), require);
+		global->Set(V8_KeywordString(isolate(), "requireAsync"), FunctionTemplate::New(isolate(), RequireAsyncWrapper, self)->GetFunction());
+		global->Set(V8_KeywordString(isolate(), "parseJsonAsync"), FunctionTemplate::New(isolate(), ParseJsonAsyncWrapper, self)->GetFunction());
 		global->Set(V8_KeywordString(isolate(), "purge_modules"), FunctionTemplate::New(isolate(), fn2, self)->GetFunction());
 
 		auto getter = [](Local<String> property, const PropertyCallbackInfo<Value>& info) {
@@ -1739,6 +2953,7 @@ public:
 						if (Dimension == 1)
 						{
 							auto ab = ArrayBuffer::New(info.GetIsolate(), Source->GetMemory(nullptr), Source->GetSize(0));
+							FExternalMemory::Track(info.GetIsolate(), ab, Source->GetSize(0));
 							argv[0] = ab;
 
 							function->Call(info.This(), 1, argv);
@@ -1754,6 +2969,7 @@ public:
 							{
 								Indices[0] = Index;
 								auto ab = ArrayBuffer::New(info.GetIsolate(), Source->GetMemory(Indices), Inner);
+								FExternalMemory::Track(info.GetIsolate(), ab, Inner);
 								out_arr->Set(Index, ab);
 							}
 
@@ -1788,8 +3004,7 @@ public:
 		for (auto Path : Paths)
 		{
 			auto FullPath = Path / Filename;
-			auto Size = IFileManager::Get().FileSize(*FullPath);
-			if (Size != INDEX_NONE)
+			if (FScriptArchive::FindFile(FullPath) || IFileManager::Get().FileSize(*FullPath) != INDEX_NONE)
 			{
 				return IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*FullPath);
 			}
@@ -1803,7 +3018,7 @@ public:
 
 		FString Text;
 
-		FFileHelper::LoadFileToString(Text, *Path);
+		FScriptArchive::LoadFileToString(Text, Path);
 
 		return Text;
 	}
@@ -1820,7 +3035,8 @@ public:
 			TEXT("(function (global,__filename,__dirname) { %s\n;}(this,'%s','%s'));"),
 			*Script, *ScriptPath, *ScriptDir
 		);
-		return RunScript(ScriptPath, Text, 0);
+		auto script = CompileScriptFile(ScriptPath, Text);
+		return script.IsEmpty() ? Local<Value>() : RunCompiledScript(script);
 	}
 
 	void Public_RunFile(const FString& Filename)
@@ -1853,16 +3069,8 @@ public:
 		TryCatch try_catch;
 		try_catch.SetVerbose(true);
 
-		auto Path = Filename;
-#if PLATFORM_WINDOWS
-		// HACK for Visual Studio Code
-		if (Path.Len() && Path[1] == ':')
-		{
-			Path = Path.Mid(0, 1).ToLower() + Path.Mid(1);
-		}
-#endif
 		auto source = V8_String(isolate(), Script);
-		auto path = V8_String(isolate(), LocalPathToURL(Path));
+		auto path = V8_String(isolate(), GetScriptURL(Filename));
 		ScriptOrigin origin(path, Integer::New(isolate(), -line_offset));
 		auto script = Script::Compile(source, &origin);
 		if (script.IsEmpty())
@@ -1872,17 +3080,89 @@ public:
 		}
 		else
 		{
-			auto result = script->Run();
-			if (try_catch.HasCaught())
-			{
-				FJavascriptContext::FromV8(context())->UncaughtException(FV8Exception::Report(try_catch));
-				return Local<Value>();
-			}
-			else
-			{
-				return result;
-			}
+			return RunCompiledScript(script);
+		}
+	}
+
+	// Should be guarded with proper handle scope; goes through the code cache unless disabled
+	Local<Script> CompileScriptFile(const FString& Filename, const FString& Text)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		Context::Scope context_scope(context());
+
+		TryCatch try_catch;
+		try_catch.SetVerbose(true);
+
+		auto source = V8_String(isolate(), Text);
+		ScriptOrigin origin(V8_String(isolate(), GetScriptURL(Filename)));
+
+		auto script = GetDefault<UJavascriptSettings>()->bCodeCache
+			? FScriptCodeCache::Compile(context(), Text, source, origin)
+			: Script::Compile(context(), source, &origin);
+
+		Local<Script> result;
+		if (!script.ToLocal(&result))
+		{
+			FJavascriptContext::FromV8(context())->UncaughtException(FV8Exception::Report(try_catch));
+		}
+		return result;
+	}
+
+	// Should be guarded with proper handle scope; an archived script brings its own cache key and maybe a cache
+	Local<Script> CompileArchivedScript(const FString& Filename, const FString& Key, Local<String> source, const FScriptArchive::FEntry& Entry)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		Context::Scope context_scope(context());
+
+		TryCatch try_catch;
+		try_catch.SetVerbose(true);
+
+		ScriptOrigin origin(V8_String(isolate(), GetScriptURL(Filename)));
+
+		auto script = GetDefault<UJavascriptSettings>()->bCodeCache
+			? FScriptCodeCache::CompileKeyed(context(), Key, source, origin, Entry.CodeCache, Entry.CodeCacheSize)
+			: Script::Compile(context(), source, &origin);
+
+		Local<Script> result;
+		if (!script.ToLocal(&result))
+		{
+			FJavascriptContext::FromV8(context())->UncaughtException(FV8Exception::Report(try_catch));
+		}
+		return result;
+	}
+
+	// Should be guarded with proper handle scope
+	Local<Value> RunCompiledScript(Local<Script> script)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		Context::Scope context_scope(context());
+
+		TryCatch try_catch;
+		try_catch.SetVerbose(true);
+
+		auto result = script->Run();
+		if (try_catch.HasCaught())
+		{
+			FJavascriptContext::FromV8(context())->UncaughtException(FV8Exception::Report(try_catch));
+			return Local<Value>();
+		}
+		else
+		{
+			return result;
+		}
+	}
+
+	static FString GetScriptURL(const FString& Filename)
+	{
+		auto Path = Filename;
+#if PLATFORM_WINDOWS
+		// HACK for Visual Studio Code
+		if (Path.Len() && Path[1] == ':')
+		{
+			Path = Path.Mid(0, 1).ToLower() + Path.Mid(1);
 		}
+#endif
+		return LocalPathToURL(Path);
 	}
 
 	void FindPathFile(FString TargetRootPath, FString TargetFileName, TArray<FString>& OutFiles)
@@ -2148,16 +3428,234 @@ public:
 #endif
 	}
 
-	Local<Value> GetProxyFunction(UObject* Object, const TCHAR* Name)
+	void GetWrapperStats(FJavascriptWrapperReport& OutReport)
+	{
+		TMap<UStruct*, FJavascriptWrapperStats> StatsByType;
+		auto Count = [&](UStruct* Type, int32 NativeBytes) {
+			auto& Stats = StatsByType.FindOrAdd(Type);
+			Stats.Type = Type;
+			Stats.Count++;
+			Stats.NativeBytes += NativeBytes;
+		};
+
+		for (auto& Pair : ObjectToObjectMap)
+		{
+			auto Class = Pair.Key->GetClass();
+			Count(Class, Class->GetPropertiesSize());
+		}
+
+		for (auto& Pair : MemoryToObjectMap)
+		{
+			Count(Pair.Key->Struct, Pair.Key->GetOwnedSize());
+		}
+
+		// Types without wrappers anymore are reported once, with their drop
+		for (auto& Pair : LastWrapperCounts)
+		{
+			auto Type = Pair.Key.Get();
+			if (!Type || !StatsByType.Contains(Type))
+			{
+				FJavascriptWrapperStats Stats;
+				Stats.Type = Type;
+				Stats.Growth = -Pair.Value;
+				OutReport.Types.Add(Stats);
+			}
+		}
+
+		LastWrapperCounts.Empty(StatsByType.Num());
+		for (auto& Pair : StatsByType)
+		{
+			auto& Stats = Pair.Value;
+			Stats.Growth = Stats.Count - LastWrapperCounts.FindRef(Pair.Key);
+			LastWrapperCounts.Add(Pair.Key, Stats.Count);
+			OutReport.Types.Add(Stats);
+		}
+
+		OutReport.Types.Sort([](const FJavascriptWrapperStats& A, const FJavascriptWrapperStats& B) {
+			return A.NativeBytes > B.NativeBytes;
+		});
+
+		CollectRetainingPaths(OutReport.RetainingPaths);
+	}
+
+	/**
+	* Breadth-first walk over plain objects and arrays reachable from the global object and loaded modules.
+	* Wrappers, functions and proxies are not entered, accessors are skipped and interceptors bypassed, so no script runs.
+	* Array elements share one path, and only the first properties of an object are visited, so counts are a lower bound.
+	*/
+	void CollectRetainingPaths(TArray<FJavascriptRetainingPath>& OutPaths, int32 MaxDepth = 6, int32 MaxObjects = 100000, int32 MaxPaths = 16, uint32 MaxProperties = 10000)
+	{
+		Isolate::Scope isolate_scope(isolate());
+		HandleScope handle_scope(isolate());
+
+		auto ctx = context();
+		Context::Scope context_scope(ctx);
+
+		TryCatch try_catch(isolate());
+
+		struct FNode
+		{
+			Local<v8::Object> Holder;
+			FString Path;
+			int32 Depth;
+		};
+
+		TArray<FNode> Queue;
+		// Identity hashes collide, so objects sharing one are told apart by handle
+		TMultiMap<int32, Local<v8::Object>> Visited;
+		TMap<FString, int32> WrappersByPath;
+
+		auto IsWrapper = [this](Local<v8::Object> Candidate) {
+			return Candidate->InternalFieldCount() == 2 && Candidate->GetAlignedPointerFromInternalField(1) == this;
+		};
+
+		auto Enqueue = [&](Local<Value> Value, const FString& Path, int32 Depth) {
+			if (Value.IsEmpty() || !Value->IsObject() || Value->IsFunction() || Value->IsProxy())
+			{
+				return;
+			}
+
+			auto Holder = Value.As<v8::Object>();
+			if (Depth > MaxDepth || Queue.Num() >= MaxObjects || IsWrapper(Holder))
+			{
+				return;
+			}
+
+			auto Hash = Holder->GetIdentityHash();
+			for (auto It = Visited.CreateConstKeyIterator(Hash); It; ++It)
+			{
+				if (It.Value() == Holder)
+				{
+					return;
+				}
+			}
+
+			Visited.Add(Hash, Holder);
+			Queue.Add({ Holder, Path, Depth });
+		};
+
+		Enqueue(ctx->Global(), TEXT("global"), 0);
+		for (auto& Pair : Modules)
+		{
+			Enqueue(Local<Value>::New(isolate(), Pair.Value), FString::Printf(TEXT("module(%s)"), *Pair.Key), 0);
+		}
+
+		for (int32 Index = 0; Index < Queue.Num(); ++Index)
+		{
+			// Queue may grow while the node is in use
+			auto Node = Queue[Index];
+			const bool bIsArray = Node.Holder->IsArray();
+
+			Local<Array> Names;
+			if (!Node.Holder->GetOwnPropertyNames(ctx).ToLocal(&Names))
+			{
+				try_catch.Reset();
+				continue;
+			}
+
+			int32 NumWrappers = 0;
+			const uint32 NumNames = FMath::Min(Names->Length(), MaxProperties);
+			for (uint32 NameIndex = 0; NameIndex < NumNames; ++NameIndex)
+			{
+				// Indices come as numbers
+				Local<String> Name;
+				if (!Names->Get(ctx, NameIndex).ToLocalChecked()->ToString(ctx).ToLocal(&Name))
+				{
+					try_catch.Reset();
+					continue;
+				}
+
+				// Data properties only; reading an accessor would run its getter
+				if (!Node.Holder->HasRealNamedProperty(ctx, Name).FromMaybe(false) || Node.Holder->HasRealNamedCallbackProperty(ctx, Name).FromMaybe(true))
+				{
+					continue;
+				}
+
+				Local<Value> Value;
+				if (!Node.Holder->GetRealNamedProperty(ctx, Name).ToLocal(&Value))
+				{
+					try_catch.Reset();
+					continue;
+				}
+
+				if (Value->IsObject() && IsWrapper(Value.As<v8::Object>()))
+				{
+					NumWrappers++;
+				}
+				else
+				{
+					Enqueue(Value, bIsArray ? Node.Path + TEXT("[]") : Node.Path + TEXT(".") + StringFromV8(Name), Node.Depth + 1);
+				}
+			}
+
+			if (NumWrappers)
+			{
+				WrappersByPath.FindOrAdd(bIsArray ? Node.Path + TEXT("[]") : Node.Path) += NumWrappers;
+			}
+		}
+
+		WrappersByPath.ValueSort([](int32 A, int32 B) { return A > B; });
+		for (auto& Pair : WrappersByPath)
+		{
+			if (OutPaths.Num() >= MaxPaths) break;
+
+			FJavascriptRetainingPath Path;
+			Path.Path = Pair.Key;
+			Path.Count = Pair.Value;
+			OutPaths.Add(Path);
+		}
+	}
+
+	Local<v8::Private> GetObjectProxyKey()
+	{
+		if (ObjectProxyKey.IsEmpty())
+		{
+			ObjectProxyKey.Reset(isolate(), v8::Private::New(isolate(), V8_KeywordString(isolate(), "proxy")));
+		}
+		return Local<v8::Private>::New(isolate(), ObjectProxyKey);
+	}
+
+	Local<Value> GetObjectProxy(Local<v8::Object> Wrapper) override
+	{
+		Local<Value> Proxy;
+		if (Wrapper->GetPrivate(context(), GetObjectProxyKey()).ToLocal(&Proxy) && Proxy->IsObject())
+		{
+			return Proxy;
+		}
+		return Undefined(isolate());
+	}
+
+	void SetObjectProxy(UObject* Object, Local<v8::Object> Wrapper, Local<Value> Proxy) override
+	{
+		if (Proxy->IsObject())
+		{
+			(void)Wrapper->SetPrivate(context(), GetObjectProxyKey(), Proxy);
+			ObjectsWithProxy.Add(Object);
+		}
+		else
+		{
+			(void)Wrapper->DeletePrivate(context(), GetObjectProxyKey());
+			ObjectsWithProxy.Remove(Object);
+		}
+	}
+
+	Local<Value> GetProxyFunction(UObject* Object, Local<String> Name)
 	{
-		auto v8_obj = ExportObject(Object)->ToObject();
-		auto proxy = v8_obj->Get(V8_KeywordString(isolate(), "proxy"));
-		if (proxy.IsEmpty() || !proxy->IsObject())
+		if (!ObjectsWithProxy.Contains(Object))
+		{
+			return Undefined(isolate());
+		}
+
+		// The wrapper, and its proxy with it, may have been collected since
+		auto Wrapper = ObjectToObjectMap.Find(Object);
+		auto Proxy = Wrapper ? GetObjectProxy(Local<Value>::New(isolate(), *Wrapper).As<v8::Object>()) : Local<Value>(Undefined(isolate()));
+		if (!Proxy->IsObject())
 		{
+			ObjectsWithProxy.Remove(Object);
 			return Undefined(isolate());
 		}
 
-		auto func = proxy->ToObject()->Get(V8_KeywordString(isolate(), Name));
+		auto func = Proxy.As<v8::Object>()->Get(Name);
 		if (func.IsEmpty() || !func->IsFunction())
 		{
 			return Undefined(isolate());
@@ -2166,9 +3664,52 @@ public:
 		return func;
 	}
 
+	Local<Value> GetProxyFunction(UObject* Object, const TCHAR* Name)
+	{
+		return GetProxyFunction(Object, V8_KeywordString(isolate(), Name));
+	}
+
 	Local<Value> GetProxyFunction(UObject* Object, UFunction* Function)
 	{
-		return GetProxyFunction(Object, *FV8Config::Safeify(Function->GetName()));
+		// Generated classes resolve their proxy functions up front; anything missing there isn't overridden.
+		if (auto Class = Cast<UClass>(Object))
+		{
+			if (auto Table = ProxyFunctionTables.Find(Class))
+			{
+				if (auto Proxy = Table->Functions.Find(Function))
+				{
+					return Local<v8::Function>::New(isolate(), *Proxy);
+				}
+				return Undefined(isolate());
+			}
+		}
+
+		// A 'proxy' of the object itself comes first; it may change at any time, so only the safeified name is cached.
+		if (ObjectsWithProxy.Contains(Object))
+		{
+			auto Name = ProxyFunctionNames.Find(Function->GetFName());
+			if (!Name)
+			{
+				Name = &ProxyFunctionNames.Add(Function->GetFName(), v8::Global<String>(isolate(), V8_KeywordString(isolate(), FV8Config::Safeify(Function->GetName()))));
+			}
+
+			auto func = GetProxyFunction(Object, Local<String>::New(isolate(), *Name));
+			if (func->IsFunction())
+			{
+				return func;
+			}
+		}
+
+		// Instances of generated classes share the table of their class, which holds inherited functions as well
+		if (auto Table = ProxyFunctionTables.Find(Object->GetClass()))
+		{
+			if (auto Proxy = Table->Functions.Find(Function))
+			{
+				return Local<v8::Function>::New(isolate(), *Proxy);
+			}
+		}
+
+		return Undefined(isolate());
 	}
 
 	bool HasProxyFunction(UObject* Holder, UFunction* Function)
@@ -2176,7 +3717,7 @@ public:
 		Isolate::Scope isolate_scope(isolate());
 		HandleScope handle_scope(isolate());
 
-		auto func = GetProxyFunction(Holder, Function);;
+		auto func = GetProxyFunction(Holder, Function);
 		return !func.IsEmpty() && func->IsFunction();
 	}
 
@@ -2238,6 +3779,13 @@ public:
 	}
 };
 
+FJavascriptContext::FJavascriptContext(TSharedPtr<FJavascriptIsolate> InEnvironment)
+	: Environment(InEnvironment)
+{}
+
+FJavascriptContext::~FJavascriptContext()
+{}
+
 FJavascriptContext* FJavascriptContext::FromV8(v8::Local<v8::Context> Context)
 {
 	if (Context.IsEmpty()) return nullptr;
@@ -2253,6 +3801,21 @@ FJavascriptContext* FJavascriptContext::FromV8(v8::Local<v8::Context> Context)
 	}
 }
 
+void FJavascriptContext::ImportModuleDynamically(v8::Isolate* isolate, v8::Local<v8::String> referrer, v8::Local<v8::String> specifier, v8::Local<v8::DynamicImportResult> result)
+{
+	auto context = isolate->GetCurrentContext();
+
+	auto Instance = static_cast<FJavascriptContextImplementation*>(FromV8(context));
+	if (Instance)
+	{
+		Instance->ImportEsModule(StringFromV8(specifier), StringFromV8(referrer), result);
+	}
+	else
+	{
+		(void)result->FinishDynamicImportFailure(context, Exception::Error(V8_String(isolate, "import() is not available here")));
+	}
+}
+
 FJavascriptContext* FJavascriptContext::Create(TSharedPtr<FJavascriptIsolate> InEnvironment, TArray<FString>& InPaths)
 {
 	return new FJavascriptContextImplementation(InEnvironment, InPaths);
@@ -2262,8 +3825,6 @@ FJavascriptContext* FJavascriptContext::Create(TSharedPtr<FJavascriptIsolate> In
 
 inline void FJavascriptContextImplementation::AddReferencedObjects(UObject * InThis, FReferenceCollector & Collector)
 {
-	Public_RunScript(TEXT("gc();"), false);
-
 	// All objects
 	for (auto It = ObjectToObjectMap.CreateIterator(); It; ++It)
 	{
@@ -2285,6 +3846,7 @@ inline void FJavascriptContextImplementation::AddReferencedObjects(UObject * InT
 		auto Struct = It.Key()->Struct;
 		if (Struct->IsPendingKill())
 		{
+			FExternalMemory::Adjust(isolate(), -It.Key()->GetOwnedSize());
 			It.RemoveCurrent();
 		}
 		else
@@ -2292,6 +3854,24 @@ inline void FJavascriptContextImplementation::AddReferencedObjects(UObject * InT
 			Collector.AddReferencedObject(Struct, InThis);
 		}
 	}
+
+	// Proxy function tables of classes which are gone
+	for (auto It = ProxyFunctionTables.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Objects which are gone
+	for (auto It = ObjectsWithProxy.CreateIterator(); It; ++It)
+	{
+		if (!It->IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
 }
 
 PRAGMA_ENABLE_SHADOW_VARIABLE_WARNINGS
@@ -1,10 +1,12 @@
 #pragma once
 
 struct FStructMemoryInstance;
+struct FJavascriptWrapperReport;
 
 struct FJavascriptContext : TSharedFromThis<FJavascriptContext>
 {
-	FJavascriptContext(TSharedPtr<FJavascriptIsolate> InEnvironment) : Environment(InEnvironment) {}
+	/** Out of line, as FStructMemoryInstance is incomplete here */
+	FJavascriptContext(TSharedPtr<FJavascriptIsolate> InEnvironment);
 
 	/** Isolate **/
 	TSharedPtr<FJavascriptIsolate> Environment;
@@ -13,14 +15,15 @@ struct FJavascriptContext : TSharedFromThis<FJavascriptContext>
 	TMap< UObject*, v8::UniquePersistent<v8::Value> > ObjectToObjectMap;
 
 	/** A map from Struct buffer to V8 Object */
-	TMap< TSharedPtr<FStructMemoryInstance>, v8::UniquePersistent<v8::Value> > MemoryToObjectMap;
+	TMap< TRefCountPtr<FStructMemoryInstance>, v8::UniquePersistent<v8::Value> > MemoryToObjectMap;
 
-	virtual ~FJavascriptContext() {}
+	virtual ~FJavascriptContext();
 	virtual void Expose(FString RootName, UObject* Object) = 0;
 	virtual FString GetScriptFileFullPath(const FString& Filename) = 0;
 	virtual FString ReadScriptFile(const FString& Filename) = 0;
 	virtual FString Public_RunScript(const FString& Script, bool bOutput = true) = 0;
 	virtual void Public_RunFile(const FString& Filename) = 0;
+	virtual void Public_RunModule(const FString& Filename) = 0;
     virtual void FindPathFile(const FString TargetRootPath, const FString TargetFileName, TArray<FString>& OutFiles) = 0;
 	virtual void SetAsDebugContext(int32 InPort) = 0;
 	virtual void ResetAsDebugContext() = 0;
@@ -29,6 +32,7 @@ struct FJavascriptContext : TSharedFromThis<FJavascriptContext>
 	virtual void DestroyInspector() = 0;
 	virtual bool WriteAliases(const FString& Filename) = 0;
 	virtual bool WriteDTS(const FString& Filename, bool bIncludingTooltip) = 0;
+	virtual void GetWrapperStats(FJavascriptWrapperReport& OutReport) = 0;
 	virtual bool HasProxyFunction(UObject* Holder, UFunction* Function) = 0;
 	virtual bool CallProxyFunction(UObject* Holder, UObject* This, UFunction* FunctionToCall, void* Parms) = 0;
 
@@ -38,12 +42,19 @@ struct FJavascriptContext : TSharedFromThis<FJavascriptContext>
 	virtual v8::Local<v8::Context> context() = 0;
 	virtual v8::Local<v8::Value> ExportObject(UObject* Object, bool bForce = false) = 0;
 	virtual v8::Local<v8::Value> GetProxyFunction(UObject* Object, const TCHAR* Name) = 0;
+
+	/** Backs the 'proxy' property of object wrappers, which hold it privately; non-objects clear it */
+	virtual v8::Local<v8::Value> GetObjectProxy(v8::Local<v8::Object> Wrapper) = 0;
+	virtual void SetObjectProxy(UObject* Object, v8::Local<v8::Object> Wrapper, v8::Local<v8::Value> Proxy) = 0;
 	virtual void AddClassFunctionToNativeModule(const FString& moduleName,
 		const FString& className, const v8::Local<v8::Function>& classFunction
 	) = 0;
 
 	static FJavascriptContext* FromV8(v8::Local<v8::Context> Context);
 
+	/** Host callback of import(), which the isolate routes to the importing context */
+	static void ImportModuleDynamically(v8::Isolate* isolate, v8::Local<v8::String> referrer, v8::Local<v8::String> specifier, v8::Local<v8::DynamicImportResult> result);
+
 	static FJavascriptContext* Create(TSharedPtr<FJavascriptIsolate> InEnvironment, TArray<FString>& InPaths);
 
 	virtual void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector) = 0;
@@ -8,7 +8,7 @@ PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
 #include "JavascriptIsolate_Private.h"
 #include "Templates/Tuple.h"
 #include "Config.h"
-#include "MallocArrayBufferAllocator.h"
+#include "PooledArrayBufferAllocator.h"
 #include "Translator.h"
 #include "ScopedArguments.h"
 #include "Exception.h"
@@ -17,10 +17,19 @@ PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
 #include "JavascriptContext_Private.h"
 #include "JavascriptContext.h"
 #include "Helpers.h"
+#include "ExternalMemory.h"
+#include "AsyncFileWriter.h"
+#include "JavascriptWorker.h"
+#include "SharedMemoryBlock.h"
 #include "JavascriptGeneratedClass.h"
 #include "JavascriptGeneratedClass_Native.h"
 #include "StructMemoryInstance.h"
 #include "JavascriptMemoryObject.h"
+#include "JavascriptLatentAction.h"
+#include "Engine/LatentActionManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/CoreDelegates.h"
 #include "Engine/UserDefinedStruct.h"
 #include "Ticker.h"
 #include "V8PCH.h"
@@ -32,6 +41,7 @@ PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
 #include "ScopedTransaction.h"
 #endif
 #include "JavascriptStats.h"
+#include "JavascriptSettings.h"
 #include "IV8.h"
 
 THIRD_PARTY_INCLUDES_START
@@ -133,13 +143,82 @@ public:
 	Persistent<ObjectTemplate> GlobalTemplate;
 
 	// Allocator instance should be set for V8's ArrayBuffer's
-	FMallocArrayBufferAllocator AllocatorInstance;
+	FPooledArrayBufferAllocator AllocatorInstance;
 
 	IDelegateManager* Delegates;
 
+	/** Promise returned by a latent function, waiting for the latent action to complete */
+	struct FPendingLatentAction
+	{
+		TWeakPtr<FJavascriptContext> Context;
+		v8::Global<v8::Promise::Resolver> Resolver;
+		/** Whose action manager holds the action; null until the latent function returned */
+		TWeakObjectPtr<UWorld> World;
+	};
+
+	/** Callback target of all latent actions started by this isolate */
+	UJavascriptLatentAction* LatentActionCallback{ nullptr };
+
+	/** Maps a latent action linkage to its promise */
+	TMap<int32, FPendingLatentAction> PendingLatentActions;
+
+	int32 NextLatentActionLinkage{ 0 };
+
+	/** Worker started by a script, with the object which receives its messages */
+	struct FWorkerBinding
+	{
+		TSharedPtr<FJavascriptWorker> Worker;
+		TWeakPtr<FJavascriptContext> Context;
+		v8::Global<v8::Object> Object;
+	};
+
+	/** Maps a worker id to its binding; running workers are kept alive until they finish or get terminated */
+	TMap<int32, FWorkerBinding> Workers;
+
+	int32 NextWorkerId{ 0 };
+
 	FTickerDelegate TickDelegate;
 	FDelegateHandle TickHandle;
 
+	FDelegateHandle PreGarbageCollectHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+
+	FDelegateHandle MemoryTrimHandle;
+	FDelegateHandle OutOfMemoryHandle;
+	FDelegateHandle EnterBackgroundHandle;
+	FDelegateHandle EnterForegroundHandle;
+	FDelegateHandle WorldCleanupHandle;
+	FDelegateHandle PostWorldInitializationHandle;
+
+	/** Whether the application has been sent to background */
+	bool bApplicationInBackground{ false };
+
+	/** Strongest MemoryPressureLevel reported since the last tick; written from any thread */
+	volatile int32 PendingMemoryPressure{ (int32)MemoryPressureLevel::kNone };
+
+	/** When engine GC finished last time */
+	double LastEngineGarbageCollectTime{ 0 };
+
+	/** Live heap size which triggers near-heap-limit handling; 0 when no limit was configured */
+	int64 HeapLimitThreshold{ 0 };
+
+	/** Configured old generation limit and the headroom V8 was given above it */
+	int64 HeapSoftLimit{ 0 };
+	int64 HeapLimitHeadroom{ 0 };
+
+	EJavascriptHeapLimitAction NearHeapLimitAction{ EJavascriptHeapLimitAction::RaiseOnce };
+	bool bSnapshotNearHeapLimit{ true };
+
+	/** Whether the limit has been raised already */
+	bool bHeapLimitRaised{ false };
+
+	/** Whether an interrupt is pending to handle the limit */
+	bool bNearHeapLimitRequested{ false };
+
+	/** Seconds between periodic allocation profiles; 0 when disabled */
+	float AllocationProfileExportInterval{ 0 };
+	double LastAllocationProfileExportTime{ 0 };
+
 	struct FObjectPropertyAccessors
 	{
 		static void* This(Local<Value> self)
@@ -294,9 +373,102 @@ public:
 
 		Delegates = IDelegateManager::Create(isolate);
 
+		LatentActionCallback = NewObject<UJavascriptLatentAction>();
+		LatentActionCallback->JavascriptIsolate = this;
+
 #if STATS
 		SetupCallbacks();
 #endif
+
+		isolate_->AddGCEpilogueCallback([](Isolate* isolate, GCType type, GCCallbackFlags flags) {
+			GetSelf(isolate)->CheckHeapLimit();
+		}, kGCTypeMarkSweepCompact);
+	}
+
+	void ConfigureHeapLimit(const FJavascriptIsolateParams& Params, Isolate::CreateParams& params)
+	{
+		if (Params.MaxSemiSpaceSizeMB > 0)
+		{
+			params.constraints.set_max_semi_space_size(Params.MaxSemiSpaceSizeMB);
+		}
+
+		if (Params.MaxOldSpaceSizeMB > 0)
+		{
+			// V8 gets the headroom on top, so that reaching the configured limit is not fatal yet
+			auto Headroom = FMath::Max(Params.HeapLimitHeadroomMB, 0);
+			params.constraints.set_max_old_space_size(Params.MaxOldSpaceSizeMB + Headroom);
+
+			HeapSoftLimit = (int64)Params.MaxOldSpaceSizeMB * 1024 * 1024;
+			HeapLimitHeadroom = (int64)Headroom * 1024 * 1024;
+			HeapLimitThreshold = HeapSoftLimit;
+			NearHeapLimitAction = Params.NearHeapLimitAction;
+			bSnapshotNearHeapLimit = Params.bSnapshotNearHeapLimit;
+		}
+	}
+
+	/** Called after full GC, so used heap size approximates live size */
+	void CheckHeapLimit()
+	{
+		if (!HeapLimitThreshold || bNearHeapLimitRequested)
+		{
+			return;
+		}
+
+		HeapStatistics stats;
+		isolate_->GetHeapStatistics(&stats);
+
+		auto Used = (int64)stats.used_heap_size();
+		if (Used < HeapLimitThreshold)
+		{
+			// Heap recovered; a raised limit may be granted again next time
+			if (bHeapLimitRaised && Used < HeapSoftLimit)
+			{
+				bHeapLimitRaised = false;
+				HeapLimitThreshold = HeapSoftLimit;
+			}
+			return;
+		}
+
+		// Snapshot and termination cannot happen within GC; wait until script execution can be interrupted
+		bNearHeapLimitRequested = true;
+		isolate_->RequestInterrupt([](Isolate* isolate, void*) {
+			GetSelf(isolate)->HandleNearHeapLimit();
+		}, nullptr);
+	}
+
+	void HandleNearHeapLimit()
+	{
+		bNearHeapLimitRequested = false;
+
+		HeapStatistics stats;
+		isolate_->GetHeapStatistics(&stats);
+
+		const bool bTerminate = bHeapLimitRaised || NearHeapLimitAction == EJavascriptHeapLimitAction::Terminate;
+
+		UE_LOG(Javascript, Error, TEXT("Javascript heap is near its limit: %lld MB used, limit %lld MB; %s"),
+			(int64)stats.used_heap_size() / (1024 * 1024),
+			HeapLimitThreshold / (1024 * 1024),
+			bTerminate ? TEXT("terminating execution") : TEXT("raising limit once"));
+
+		if (bSnapshotNearHeapLimit && !bHeapLimitRaised)
+		{
+			auto Filename = FPaths::GameSavedDir() / TEXT("Javascript") / FString::Printf(TEXT("NearHeapLimit-%s.heapsnapshot"), *FDateTime::Now().ToString());
+			if (WriteHeapSnapshot(isolate_, Filename))
+			{
+				UE_LOG(Javascript, Error, TEXT("Heap snapshot written to %s"), *Filename);
+			}
+		}
+
+		if (bTerminate)
+		{
+			isolate_->TerminateExecution();
+		}
+		else
+		{
+			// The other half of the headroom is left for unwinding after termination
+			bHeapLimitRaised = true;
+			HeapLimitThreshold = HeapSoftLimit + HeapLimitHeadroom / 2;
+		}
 	}
 
 #if STATS
@@ -375,22 +547,48 @@ public:
 	}
 #endif
 
-	FJavascriptIsolateImplementation()
+	FJavascriptIsolateImplementation(const FJavascriptIsolateParams& Params)
 	{
 		Isolate::CreateParams params;
 
 		// Set our array buffer allocator instance
+		AllocatorInstance.Configure(Params.bPoolArrayBuffers, Params.bLazyZeroLargeArrayBuffers, (int64)Params.MaxPooledArrayBufferMB * 1024 * 1024);
 		params.array_buffer_allocator = &AllocatorInstance;
 
+		ConfigureHeapLimit(Params, params);
+
+		params.host_import_module_dynamically_callback_ = &FJavascriptContext::ImportModuleDynamically;
+
 		// Bind this instance to newly created V8 isolate
 		RegisterSelf(Isolate::New(params));
 
+		IV8::Get().AddIdleTimeIsolate(isolate_);
+
+		if (Params.bSamplingHeapProfiler)
+		{
+			isolate_->GetHeapProfiler()->StartSamplingHeapProfiler((uint64_t)FMath::Max(Params.SamplingHeapProfilerIntervalKB, 1) * 1024);
+
+			AllocationProfileExportInterval = Params.AllocationProfileExportInterval;
+			LastAllocationProfileExportTime = FPlatformTime::Seconds();
+		}
+
 		GenerateBlueprintFunctionLibraryMapping();
 
 		InitializeGlobalTemplate();
 
 		TickDelegate = FTickerDelegate::CreateRaw(this, &FJavascriptIsolateImplementation::HandleTicker);
 		TickHandle = FTicker::GetCoreTicker().AddTicker(TickDelegate);
+
+		LastEngineGarbageCollectTime = FPlatformTime::Seconds();
+		PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(this, &FJavascriptIsolateImplementation::OnPreGarbageCollect);
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FJavascriptIsolateImplementation::OnPostGarbageCollect);
+
+		MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddRaw(this, &FJavascriptIsolateImplementation::OnMemoryPressure, MemoryPressureLevel::kModerate);
+		OutOfMemoryHandle = FCoreDelegates::GetOutOfMemoryDelegate().AddRaw(this, &FJavascriptIsolateImplementation::OnMemoryPressure, MemoryPressureLevel::kCritical);
+		EnterBackgroundHandle = FCoreDelegates::ApplicationWillEnterBackgroundDelegate.AddRaw(this, &FJavascriptIsolateImplementation::OnApplicationBackground, true);
+		EnterForegroundHandle = FCoreDelegates::ApplicationHasEnteredForegroundDelegate.AddRaw(this, &FJavascriptIsolateImplementation::OnApplicationBackground, false);
+		WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddRaw(this, &FJavascriptIsolateImplementation::OnWorldCleanup);
+		PostWorldInitializationHandle = FWorldDelegates::OnPostWorldInitialization.AddRaw(this, &FJavascriptIsolateImplementation::OnPostWorldInitialization);
 	}
 
 	void InitializeGlobalTemplate()
@@ -431,6 +629,8 @@ public:
 		ExportMemory(ObjectTemplate);
 
 		ExportMisc(ObjectTemplate);
+
+		ExportWorker(ObjectTemplate);
 	}
 
 	~FJavascriptIsolateImplementation()
@@ -440,8 +640,23 @@ public:
 		Delegates->Destroy();
 		Delegates = nullptr;
 
+		LatentActionCallback->JavascriptIsolate = nullptr;
+		LatentActionCallback = nullptr;
+
 		FTicker::GetCoreTicker().RemoveTicker(TickHandle);
 
+		FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+		FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+		FCoreDelegates::GetOutOfMemoryDelegate().Remove(OutOfMemoryHandle);
+		FCoreDelegates::ApplicationWillEnterBackgroundDelegate.Remove(EnterBackgroundHandle);
+		FCoreDelegates::ApplicationHasEnteredForegroundDelegate.Remove(EnterForegroundHandle);
+		FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+		FWorldDelegates::OnPostWorldInitialization.Remove(PostWorldInitializationHandle);
+
+		IV8::Get().RemoveIdleTimeIsolate(isolate_);
+
 		isolate_->Dispose();
 	}
 
@@ -449,9 +664,166 @@ public:
 	{
 		auto platform = reinterpret_cast<v8::Platform*>(IV8::Get().GetV8Platform());
 		v8::platform::PumpMessageLoop(platform,isolate_);
+
+		ReleaseMemoryIfPressured();
+		RejectAbortedLatentActions();
+		GiveIdleTimeHintIfDue();
+		ExportAllocationProfileIfDue();
+		DispatchWorkerMessages();
 		return true;
 	}
 
+	void ExportAllocationProfileIfDue()
+	{
+		if (AllocationProfileExportInterval <= 0 || FPlatformTime::Seconds() - LastAllocationProfileExportTime < AllocationProfileExportInterval)
+		{
+			return;
+		}
+
+		LastAllocationProfileExportTime = FPlatformTime::Seconds();
+
+		Isolate::Scope isolate_scope(isolate_);
+		auto Filename = FPaths::GameSavedDir() / TEXT("Javascript") / FString::Printf(TEXT("AllocationProfile-%p-%s.heapprofile"), isolate_, *FDateTime::Now().ToString());
+		WriteAllocationProfile(isolate_, Filename);
+	}
+
+	/**
+	* Gives V8 idle time every tick shortly before engine GC is expected. It is a hint: V8 may spend it on
+	* starting and advancing incremental marking, or ignore it.
+	*/
+	void GiveIdleTimeHintIfDue()
+	{
+		const auto& Settings = *GetDefault<UJavascriptSettings>();
+		if (Settings.GarbageCollectionPolicy != EJavascriptGarbageCollectionPolicy::IdleTimeHints || Settings.IdleHintStepBudgetMs <= 0 || !GEngine)
+		{
+			return;
+		}
+
+		const double Interval = GEngine->TimeBetweenPurgingPendingKillObjects;
+		if (FPlatformTime::Seconds() - LastEngineGarbageCollectTime < Interval - Settings.IdleHintLeadTime)
+		{
+			return;
+		}
+
+		auto platform = reinterpret_cast<v8::Platform*>(IV8::Get().GetV8Platform());
+
+		Isolate::Scope isolate_scope(isolate_);
+		isolate_->IdleNotificationDeadline(platform->MonotonicallyIncreasingTime() + Settings.IdleHintStepBudgetMs / 1000.0);
+	}
+
+	void OnPreGarbageCollect()
+	{
+		const auto& Settings = *GetDefault<UJavascriptSettings>();
+
+		Isolate::Scope isolate_scope(isolate_);
+
+		switch (Settings.GarbageCollectionPolicy)
+		{
+		case EJavascriptGarbageCollectionPolicy::IdleTimeHints:
+			// One more hint within budget; marking which does not finish in it is left to V8's next collection
+			if (Settings.IdleHintFinalBudgetMs > 0)
+			{
+				auto platform = reinterpret_cast<v8::Platform*>(IV8::Get().GetV8Platform());
+				isolate_->IdleNotificationDeadline(platform->MonotonicallyIncreasingTime() + Settings.IdleHintFinalBudgetMs / 1000.0);
+			}
+			break;
+		case EJavascriptGarbageCollectionPolicy::Forced:
+			isolate_->LowMemoryNotification();
+			break;
+		default:
+			break;
+		}
+	}
+
+	void OnPostGarbageCollect()
+	{
+		LastEngineGarbageCollectTime = FPlatformTime::Seconds();
+	}
+
+	/**
+	* Engine wants memory back. The out-of-memory delegate fires on whichever thread failed to allocate, so only
+	* the notification, which V8 accepts from any thread, happens here; collecting and trimming wait for the next tick.
+	*/
+	void OnMemoryPressure(MemoryPressureLevel Level)
+	{
+		isolate_->MemoryPressureNotification(Level);
+
+		for (;;)
+		{
+			auto Pending = PendingMemoryPressure;
+			if (Pending >= (int32)Level || FPlatformAtomics::InterlockedCompareExchange(&PendingMemoryPressure, (int32)Level, Pending) == Pending)
+			{
+				break;
+			}
+		}
+	}
+
+	/** Game thread part of OnMemoryPressure; critical pressure collects everything collectable */
+	void ReleaseMemoryIfPressured()
+	{
+		auto Level = (MemoryPressureLevel)FPlatformAtomics::InterlockedExchange(&PendingMemoryPressure, (int32)MemoryPressureLevel::kNone);
+		if (Level == MemoryPressureLevel::kNone)
+		{
+			return;
+		}
+
+		Isolate::Scope isolate_scope(isolate_);
+
+		if (Level == MemoryPressureLevel::kCritical)
+		{
+			isolate_->LowMemoryNotification();
+		}
+		isolate_->MemoryPressureNotification(MemoryPressureLevel::kNone);
+
+		AllocatorInstance.Trim();
+	}
+
+	/** V8 favors memory footprint over latency while in background */
+	void OnApplicationBackground(bool bBackground)
+	{
+		bApplicationInBackground = bBackground;
+
+		if (bBackground)
+		{
+			isolate_->IsolateInBackgroundNotification();
+		}
+		else
+		{
+			isolate_->IsolateInForegroundNotification();
+		}
+	}
+
+	/** Nothing latency-sensitive runs between a world teardown and the next world */
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+	{
+		// Actions of the world are dropped along with it
+		TArray<int32> Aborted;
+		for (const auto& Pair : PendingLatentActions)
+		{
+			if (Pair.Value.World == World)
+			{
+				Aborted.Add(Pair.Key);
+			}
+		}
+		for (auto Linkage : Aborted)
+		{
+			SettleLatentAction(Linkage, TEXT("Latent action was aborted as its world was cleaned up"));
+		}
+
+		if (bCleanupResources)
+		{
+			isolate_->IsolateInBackgroundNotification();
+		}
+	}
+
+	void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS)
+	{
+		if (!bApplicationInBackground)
+		{
+			isolate_->IsolateInForegroundNotification();
+		}
+	}
+
 	void ReleaseAllPersistentHandles()
 	{
 		// Release all exported classes
@@ -460,6 +832,12 @@ public:
 		// Release all exported structs(non-class)
 		ScriptStructToFunctionTemplateMap.Empty();
 
+		// Pending promises are never resolved
+		PendingLatentActions.Empty();
+
+		// Waits for worker threads to exit
+		Workers.Empty();
+
 		ModuleNameToFunctionTemplateMap.Empty();
 
 		// Release global template
@@ -542,6 +920,283 @@ public:
 		{
 			Collector.AddReferencedObject(It.Key(), InThis);
 		}
+
+		Collector.AddReferencedObject(LatentActionCallback, InThis);
+	}
+
+	/** Routes a latent action to our callback target and returns a promise which settles when it completes */
+	Local<Promise> BeginLatentAction(FLatentActionInfo& LatentInfo)
+	{
+		auto context = isolate_->GetCurrentContext();
+		auto Resolver = Promise::Resolver::New(context).ToLocalChecked();
+
+		NextLatentActionLinkage = NextLatentActionLinkage == MAX_int32 ? 1 : NextLatentActionLinkage + 1;
+
+		// UUID should be unique per callback target, otherwise the action would be rejected as a duplicate
+		LatentInfo.Linkage = NextLatentActionLinkage;
+		LatentInfo.UUID = NextLatentActionLinkage;
+		LatentInfo.ExecutionFunction = GET_FUNCTION_NAME_CHECKED(UJavascriptLatentAction, Resume);
+		LatentInfo.CallbackTarget = LatentActionCallback;
+
+		auto& Pending = PendingLatentActions.Add(NextLatentActionLinkage);
+		if (auto Context = FJavascriptContext::FromV8(context))
+		{
+			Pending.Context = Context->AsShared();
+		}
+		Pending.Resolver.Reset(isolate_, Resolver);
+
+		return Resolver->GetPromise();
+	}
+
+	/** Called once the latent function returned; its promise is rejected unless the action is pending in some world by now */
+	void OnLatentFunctionReturned(int32 Linkage)
+	{
+		auto Pending = PendingLatentActions.Find(Linkage);
+		if (!Pending || !GEngine)
+		{
+			return;
+		}
+
+		for (const auto& WorldContext : GEngine->GetWorldContexts())
+		{
+			auto World = WorldContext.World();
+			if (World && World->GetLatentActionManager().FindExistingAction<::FPendingLatentAction>(LatentActionCallback, Linkage))
+			{
+				Pending->World = World;
+				return;
+			}
+		}
+
+		SettleLatentAction(Linkage, TEXT("Latent action was not started"));
+	}
+
+	/** Actions which left their world's action manager without completing, as their world or object went away */
+	void RejectAbortedLatentActions()
+	{
+		TArray<int32> Aborted;
+		for (const auto& Pair : PendingLatentActions)
+		{
+			if (Pair.Value.World.IsExplicitlyNull())
+			{
+				continue;
+			}
+
+			auto World = Pair.Value.World.Get();
+			if (!World || !World->GetLatentActionManager().FindExistingAction<::FPendingLatentAction>(LatentActionCallback, Pair.Key))
+			{
+				Aborted.Add(Pair.Key);
+			}
+		}
+
+		for (auto Linkage : Aborted)
+		{
+			SettleLatentAction(Linkage, TEXT("Latent action was aborted"));
+		}
+	}
+
+	/** Worker object keeps its id under a private key, as internal fields are reserved for engine wrappers */
+	Local<Private> GetWorkerIdKey()
+	{
+		return Private::ForApi(isolate_, V8_KeywordString(isolate_, "Worker"));
+	}
+
+	FWorkerBinding* FindWorker(Local<Object> Object)
+	{
+		auto Id = Object->GetPrivate(isolate_->GetCurrentContext(), GetWorkerIdKey());
+		Local<Value> Value;
+		if (!Id.ToLocal(&Value) || !Value->IsInt32())
+		{
+			return nullptr;
+		}
+		return Workers.Find(Value->Int32Value());
+	}
+
+	void ExportWorker(Local<ObjectTemplate> global_templ)
+	{
+		FIsolateHelper I(isolate_);
+
+		auto Template = I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+		{
+			auto isolate = info.GetIsolate();
+			FIsolateHelper I(isolate);
+
+			if (!info.IsConstructCall() || info.Length() < 1)
+			{
+				I.Throw(TEXT("Usage: new Worker(filename)"));
+				return;
+			}
+
+			auto Self = GetSelf(isolate);
+			auto Context = FJavascriptContext::FromV8(isolate->GetCurrentContext());
+			auto Filename = Context->GetScriptFileFullPath(StringFromV8(info[0]));
+
+			auto Id = Self->NextWorkerId++;
+			auto& Binding = Self->Workers.Add(Id);
+			Binding.Worker = MakeShareable(new FJavascriptWorker(Filename, Self->AllocatorInstance));
+			Binding.Context = Context->AsShared();
+			Binding.Object.Reset(isolate, info.This());
+
+			(void)info.This()->SetPrivate(isolate->GetCurrentContext(), Self->GetWorkerIdKey(), Integer::New(isolate, Id));
+
+			Binding.Worker->Start();
+		});
+
+		auto add_fn = [&](const char* name, FunctionCallback fn) {
+			Template->PrototypeTemplate()->Set(I.Keyword(name), I.FunctionTemplate(fn));
+		};
+
+		add_fn("postMessage", [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto isolate = info.GetIsolate();
+			auto Self = GetSelf(isolate);
+
+			auto Binding = Self->FindWorker(info.This());
+			if (!Binding || Binding->Worker->IsFinished())
+			{
+				return;
+			}
+
+			auto Message = FJavascriptMessage::Serialize(isolate, isolate->GetCurrentContext(), info[0], info[1], &Self->AllocatorInstance);
+			if (Message.IsValid())
+			{
+				Binding->Worker->PostMessage(MoveTemp(Message));
+			}
+		});
+
+		add_fn("terminate", [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto Self = GetSelf(info.GetIsolate());
+
+			if (auto Binding = Self->FindWorker(info.This()))
+			{
+				Binding->Worker->Terminate();
+			}
+		});
+
+		Template->SetClassName(I.Keyword("Worker"));
+
+		global_templ->Set(I.Keyword("Worker"), Template);
+	}
+
+	/** Delivers messages posted by workers to onmessage of their objects */
+	void DispatchWorkerMessages()
+	{
+		if (Workers.Num() == 0)
+		{
+			return;
+		}
+
+		Isolate::Scope isolate_scope(isolate_);
+
+		TArray<int32> Ids;
+		Workers.GetKeys(Ids);
+
+		for (auto Id : Ids)
+		{
+			// Handlers may terminate workers, so bindings are looked up for every message
+			for (;;)
+			{
+				auto Binding = Workers.Find(Id);
+				if (!Binding)
+				{
+					break;
+				}
+
+				// Read before the queue, so that nothing posted right before the worker finished gets lost
+				const bool bFinished = Binding->Worker->IsFinished();
+
+				auto Context = Binding->Context.Pin();
+				TUniquePtr<FJavascriptMessage> Message;
+				if (!Context.IsValid() || !Binding->Worker->ReceiveMessage(Message))
+				{
+					if (!Context.IsValid() || bFinished)
+					{
+						Workers.Remove(Id);
+					}
+					break;
+				}
+
+				HandleScope handle_scope(isolate_);
+
+				auto context = Context->context();
+				Context::Scope context_scope(context);
+
+				auto Object = Local<v8::Object>::New(isolate_, Binding->Object);
+
+				TryCatch try_catch;
+
+				auto Handler = Object->Get(V8_KeywordString(isolate_, "onmessage"));
+				Local<Value> Data;
+				if (!Handler.IsEmpty() && Handler->IsFunction() && Message->Deserialize(isolate_, context).ToLocal(&Data))
+				{
+					auto Event = v8::Object::New(isolate_);
+					Event->Set(V8_KeywordString(isolate_, "data"), Data);
+
+					Local<Value> Args[] = { Event };
+					Handler.As<Function>()->Call(Object, 1, Args);
+				}
+
+				if (try_catch.HasCaught())
+				{
+					FV8Exception::Report(try_catch);
+				}
+			}
+		}
+	}
+
+	void OnLatentActionCompleted(int32 Linkage)
+	{
+		SettleLatentAction(Linkage, nullptr);
+	}
+
+	/** Resolves the promise of an action, or rejects it with Error */
+	void SettleLatentAction(int32 Linkage, const TCHAR* Error)
+	{
+		auto Pending = PendingLatentActions.Find(Linkage);
+		if (!Pending)
+		{
+			return;
+		}
+
+		auto Context = Pending->Context.Pin();
+		if (Context.IsValid())
+		{
+			Isolate::Scope isolate_scope(isolate_);
+			HandleScope handle_scope(isolate_);
+
+			auto context = Context->context();
+			Context::Scope context_scope(context);
+
+			auto Resolver = Local<Promise::Resolver>::New(isolate_, Pending->Resolver);
+			PendingLatentActions.Remove(Linkage);
+
+			TryCatch try_catch;
+
+			if (Error)
+			{
+				(void)Resolver->Reject(context, Exception::Error(V8_String(isolate_, Error)));
+			}
+			else
+			{
+				(void)Resolver->Resolve(context, Undefined(isolate_));
+			}
+
+			// Continuations run now rather than whenever script is entered next time, unless the action
+			// completed synchronously within a call from script, which runs them once it returns
+			if (StackTrace::CurrentStackTrace(isolate_, 1)->GetFrameCount() == 0)
+			{
+				isolate_->RunMicrotasks();
+			}
+
+			if (try_catch.HasCaught())
+			{
+				FV8Exception::Report(try_catch);
+			}
+		}
+		else
+		{
+			PendingLatentActions.Remove(Linkage);
+		}
 	}
 
 	Local<Value> InternalReadProperty(UProperty* Property, uint8* Buffer, const IPropertyOwner& Owner)
@@ -1119,6 +1774,101 @@ public:
 #endif
 	}
 
+	/** Serialization has to happen on this thread, but file writes are handed off to the writer thread */
+	static bool WriteHeapSnapshot(Isolate* isolate, const FString& Filename)
+	{
+		class FileOutputStream : public OutputStream
+		{
+		public:
+			FileOutputStream(FAsyncFileWriter::FFile& file) : file_(file) {}
+
+			virtual int GetChunkSize() {
+				return 65536;  // big chunks == faster
+			}
+
+			virtual void EndOfStream() {}
+
+			virtual WriteResult WriteAsciiChunk(char* data, int size) {
+				file_.Write(data, size);
+				return kContinue;
+			}
+
+		private:
+			FAsyncFileWriter::FFile& file_;
+		};
+
+		auto File = FAsyncFileWriter::Get().Open(Filename);
+		if (!File.IsValid())
+		{
+			return false;
+		}
+
+		const HeapSnapshot* const snap = isolate->GetHeapProfiler()->TakeHeapSnapshot();
+		{
+			FileOutputStream stream(*File);
+			snap->Serialize(&stream, HeapSnapshot::kJSON);
+		}
+
+		// Work around a deficiency in the API.  The HeapSnapshot object is const
+		// but we cannot call HeapProfiler::DeleteAllHeapSnapshots() because that
+		// invalidates _all_ snapshots, including those created by other tools.
+		const_cast<HeapSnapshot*>(snap)->Delete();
+
+		return true;
+	}
+
+	/** Writes the profile of the sampling heap profiler in .heapprofile format, which DevTools can load */
+	static bool WriteAllocationProfile(Isolate* isolate, const FString& Filename)
+	{
+		HandleScope handle_scope(isolate);
+
+		TUniquePtr<AllocationProfile> Profile(isolate->GetHeapProfiler()->GetAllocationProfile());
+		if (!Profile.IsValid())
+		{
+			return false;
+		}
+
+		auto Quote = [](const FString& String) {
+			auto Escaped = String.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\""));
+			Escaped = Escaped.Replace(TEXT("\n"), TEXT("\\n")).Replace(TEXT("\r"), TEXT("\\r")).Replace(TEXT("\t"), TEXT("\\t"));
+			return FString::Printf(TEXT("\"%s\""), *Escaped);
+		};
+
+		FString Json;
+		TFunction<void(AllocationProfile::Node*)> WriteNode = [&](AllocationProfile::Node* Node) {
+			size_t SelfSize = 0;
+			for (const auto& Allocation : Node->allocations)
+			{
+				SelfSize += Allocation.size * Allocation.count;
+			}
+
+			// DevTools expects zero-based line and column numbers
+			Json += FString::Printf(TEXT("{\"callFrame\":{\"functionName\":%s,\"scriptId\":\"%d\",\"url\":%s,\"lineNumber\":%d,\"columnNumber\":%d},\"selfSize\":%llu,\"children\":["),
+				*Quote(StringFromV8(Node->name)),
+				Node->script_id,
+				*Quote(StringFromV8(Node->script_name)),
+				Node->line_number - 1,
+				Node->column_number - 1,
+				(uint64)SelfSize);
+
+			for (int32 Index = 0; Index < (int32)Node->children.size(); ++Index)
+			{
+				if (Index) Json += TEXT(",");
+				WriteNode(Node->children[Index]);
+			}
+
+			Json += TEXT("]}");
+		};
+
+		Json += TEXT("{\"head\":");
+		WriteNode(Profile->GetRootNode());
+		Json += TEXT("}");
+
+		FTCHARToUTF8 Utf8(*Json);
+		TArray<uint8> Data(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+		return FAsyncFileWriter::Get().WriteFile(Filename, MoveTemp(Data));
+	}
+
 	void ExportMemory(Local<ObjectTemplate> global_templ)
 	{
 		FIsolateHelper I(isolate_);
@@ -1143,6 +1893,7 @@ public:
 				{
 					auto ab = ArrayBuffer::New(info.GetIsolate(), Source->GetMemory(), Source->GetSize());
 					ab->Set(I.Keyword("$source"), info[0]);
+					FExternalMemory::Track(isolate, ab, Source->GetSize());
 					info.GetReturnValue().Set(ab);
 					return;
 				}
@@ -1151,6 +1902,44 @@ public:
 			I.Throw(TEXT("memory.fork requires JavascriptMemoryObject"));
 		});
 
+		// SharedArrayBuffer over a memory object (e.g. JavascriptSharedMemoryRegion), which can be posted to workers
+		add_fn("share", [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto isolate = info.GetIsolate();
+
+			FIsolateHelper I(isolate);
+
+			auto Source = info.Length() == 1 ? Cast<UJavascriptMemoryObject>(UObjectFromV8(info[0])) : nullptr;
+			if (!Source || !Source->GetMemory())
+			{
+				I.Throw(TEXT("memory.share requires JavascriptMemoryObject"));
+				return;
+			}
+
+			auto Block = FSharedMemoryBlock::Find(Source->GetMemory());
+			if (!Block.IsValid())
+			{
+				// Workers may hold the memory longer than any script here, so the object stays rooted until the last buffer is gone
+				Source->AddToRoot();
+
+				TWeakObjectPtr<UJavascriptMemoryObject> WeakSource(Source);
+				Block = FSharedMemoryBlock::Adopt(Source->GetMemory(), Source->GetSize(), [WeakSource](void*, size_t) {
+					FFunctionGraphTask::CreateAndDispatchWhenReady([WeakSource]() {
+						if (WeakSource.IsValid())
+						{
+							WeakSource->RemoveFromRoot();
+						}
+					}, TStatId(), nullptr, ENamedThreads::GameThread);
+				});
+			}
+
+			info.GetReturnValue().Set(Block->Bind(isolate));
+		});
+
+		// In-process SharedArrayBuffer by name, which every isolate and worker asking for the same name shares
+		add_fn("shared", &FSharedMemoryBlock::OpenNamed);
+		add_fn("releaseShared", &FSharedMemoryBlock::ReleaseShared);
+
 		add_fn("exec", [](const FunctionCallbackInfo<Value>& info)
 		{
 			FIsolateHelper I(info.GetIsolate());
@@ -1255,41 +2044,35 @@ public:
 		add_fn("takeSnapshot", [](const FunctionCallbackInfo<Value>& info)
 		{
 			FIsolateHelper I(info.GetIsolate());
-			class FileOutputStream : public OutputStream
-			{
-			public:
-				FileOutputStream(FArchive* ar) : ar_(ar) {}
 
-				virtual int GetChunkSize() {
-					return 65536;  // big chunks == faster
-				}
+			if (info.Length() == 1)
+			{
+				WriteHeapSnapshot(info.GetIsolate(), StringFromV8(info[0]));
+			}
+			else
+			{
+				I.Throw(TEXT("One argument needed"));
+			}
+		});
 
-				virtual void EndOfStream() {}
+		add_fn("startSampling", [](const FunctionCallbackInfo<Value>& info)
+		{
+			auto Interval = info.Length() > 0 && info[0]->IsNumber() ? (uint64_t)info[0]->NumberValue() : 512 * 1024;
+			info.GetReturnValue().Set(info.GetIsolate()->GetHeapProfiler()->StartSamplingHeapProfiler(Interval));
+		});
 
-				virtual WriteResult WriteAsciiChunk(char* data, int size) {
-					ar_->Serialize(data, size);
-					return ar_->IsError() ? kAbort : kContinue;
-				}
+		add_fn("stopSampling", [](const FunctionCallbackInfo<Value>& info)
+		{
+			info.GetIsolate()->GetHeapProfiler()->StopSamplingHeapProfiler();
+		});
 
-			private:
-				FArchive* ar_;
-			};
+		add_fn("writeAllocationProfile", [](const FunctionCallbackInfo<Value>& info)
+		{
+			FIsolateHelper I(info.GetIsolate());
 
 			if (info.Length() == 1)
 			{
-				const HeapSnapshot* const snap = info.GetIsolate()->GetHeapProfiler()->TakeHeapSnapshot();
-				FArchive* Ar = IFileManager::Get().CreateFileWriter(*StringFromV8(info[0]), 0);
-				if (Ar)
-				{
-					FileOutputStream stream(Ar);
-					snap->Serialize(&stream, HeapSnapshot::kJSON);
-					delete Ar;
-				}
-
-				// Work around a deficiency in the API.  The HeapSnapshot object is const
-				// but we cannot call HeapProfiler::DeleteAllHeapSnapshots() because that
-				// invalidates _all_ snapshots, including those created by other tools.
-				const_cast<HeapSnapshot*>(snap)->Delete();
+				info.GetReturnValue().Set(WriteAllocationProfile(info.GetIsolate(), StringFromV8(info[0])));
 			}
 			else
 			{
@@ -1331,6 +2114,10 @@ public:
 
 		int32 NumArgs = 0;
 
+		// Latent function returns a promise instead, so the caller doesn't pass latent info
+		Local<Promise> LatentPromise;
+		FLatentActionInfo* LatentInfo = nullptr;
+
 		// Iterate over input parameters
 		for (; It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It)
 		{
@@ -1339,8 +2126,14 @@ public:
 			// Get argument from caller
 			auto arg = GetArg(ArgIndex++);
 
+			auto StructProp = Cast<UStructProperty>(Prop);
+			if (StructProp && StructProp->Struct == FLatentActionInfo::StaticStruct())
+			{
+				LatentInfo = StructProp->ContainerPtrToValuePtr<FLatentActionInfo>(Buffer);
+				LatentPromise = GetSelf(isolate)->BeginLatentAction(*LatentInfo);
+			}
 			// Do we have valid argument?
-			if (!arg.IsEmpty() && !arg->IsUndefined())
+			else if (!arg.IsEmpty() && !arg->IsUndefined())
 			{
 				WriteProperty(isolate, Prop, Buffer, arg);
 			}
@@ -1360,6 +2153,13 @@ public:
 
 		Object->ProcessEvent(Function, Buffer);
 
+		// Out parameters of latent function aren't final until the action completes, so they are not reported
+		if (!LatentPromise.IsEmpty())
+		{
+			GetSelf(isolate)->OnLatentFunctionReturned(LatentInfo->UUID);
+			return handle_scope.Escape(LatentPromise);
+		}
+
 		auto FetchProperty = [&](UProperty* Param, int32 ArgIndex) -> Local<Value> {
 			if (auto p = Cast<UStructProperty>(Param))
 			{
@@ -2064,7 +2864,9 @@ public:
 					{
 						Handle<Value> argv[1];
 
-						argv[0] = ArrayBuffer::New(info.GetIsolate(), helper.GetRawPtr(), helper.Num() * p->Inner->GetSize());
+						auto ab = ArrayBuffer::New(info.GetIsolate(), helper.GetRawPtr(), helper.Num() * p->Inner->GetSize());
+						FExternalMemory::Track(info.GetIsolate(), ab, helper.Num() * p->Inner->GetSize());
+						argv[0] = ab;
 
 						auto out = function->Call(info.This(), 1, argv);
 						info.GetReturnValue().Set(out);
@@ -2230,7 +3032,7 @@ public:
 		};
 
 		auto Template = I.FunctionTemplate(ConstructorBody, ClassToExport);
-		Template->InstanceTemplate()->SetInternalFieldCount(1);
+		Template->InstanceTemplate()->SetInternalFieldCount(WrapperInternalFieldCount);
 
 		AddMemberFunction_Struct_C(Template, ClassToExport);
 
@@ -2278,9 +3080,45 @@ public:
 			}
 		}
 
+		// Every object inherits it from here
+		if (ClassToExport == UObject::StaticClass())
+		{
+			ExportObjectProxy(Template);
+		}
+
 		return handle_scope.Escape(Template);
 	}
 
+	/** 'proxy' is held privately by the wrapper; the context tracks which objects have one, so that others cost nothing */
+	void ExportObjectProxy(Local<FunctionTemplate> Template)
+	{
+		FIsolateHelper I(isolate_);
+
+		auto Getter = [](Local<String> property, const PropertyCallbackInfo<Value>& info) {
+			auto isolate = info.GetIsolate();
+
+			auto Context = FJavascriptContext::FromV8(isolate->GetCurrentContext());
+			auto Object = UObjectFromV8(info.This());
+			if (Context && Object)
+			{
+				info.GetReturnValue().Set(Context->GetObjectProxy(info.This()));
+			}
+		};
+
+		auto Setter = [](Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+			auto isolate = info.GetIsolate();
+
+			auto Context = FJavascriptContext::FromV8(isolate->GetCurrentContext());
+			auto Object = UObjectFromV8(info.This());
+			if (Context && Object)
+			{
+				Context->SetObjectProxy(Object, info.This(), value);
+			}
+		};
+
+		Template->PrototypeTemplate()->SetAccessor(I.Keyword("proxy"), Getter, Setter);
+	}
+
 	Local<FunctionTemplate> InternalExportStruct(UScriptStruct* StructToExport)
 	{
 		FIsolateHelper I(isolate_);
@@ -2299,7 +3137,7 @@ public:
 			{
 				auto self = info.This();
 
-				TSharedPtr<FStructMemoryInstance> Memory;
+				TRefCountPtr<FStructMemoryInstance> Memory;
 
 				if (info.Length() == 2 && info[0]->IsExternal() && info[1]->IsExternal())
 				{
@@ -2313,8 +3151,6 @@ public:
 				}
 
 				GetSelf(isolate)->RegisterScriptStructInstance(Memory, self);
-
-				self->SetAlignedPointerInInternalField(0, Memory.Get());
 			}
 			else
 			{
@@ -2323,7 +3159,7 @@ public:
 		};
 
 		auto Template = I.FunctionTemplate(fn, StructToExport);
-		Template->InstanceTemplate()->SetInternalFieldCount(1);
+		Template->InstanceTemplate()->SetInternalFieldCount(WrapperInternalFieldCount);
 
 		AddMemberFunction_Struct_C(Template, StructToExport);
 		AddMemberFunction_Struct_clone(Template, StructToExport);
@@ -2539,36 +3375,33 @@ public:
 		}
 	}
 
-	// For tracking exported entities
-	template <typename U, typename T>
-	void SetWeak(UniquePersistent<U>& Handle, T* GarbageCollectedObject)
+	/** Wrappers keep the native instance in field 0 and the owning context in field 1, both handed to the weak callback */
+	enum
 	{
-		typedef TPair<FJavascriptContext*, T*> WeakData;
-		typedef typename WeakData::KeyType WeakDataKeyInitType;
-		typedef typename WeakData::ValueType WeakDataValueInitType;
-		typedef TPairInitializer<WeakDataKeyInitType, WeakDataValueInitType> InitializerType;
-
-#if V8_MAJOR_VERSION == 5 && V8_MINOR_VERSION < 3
-		Handle.template SetWeak<WeakData>(new WeakData(InitializerType(GetContext(), GarbageCollectedObject)), [](const WeakCallbackData<U, WeakData>& data) {
-			auto Parameter = data.GetParameter();
-
-			auto Context = Parameter->Key;
-			auto Self = static_cast<FJavascriptIsolateImplementation*>(Context->Environment.Get());
-			Self->OnGarbageCollectedByV8(Context,Parameter->Value);
+		WrapperInternalFieldCount = 2
+	};
 
-			delete Parameter;
-		});
-#else
-		Handle.template SetWeak<WeakData>(new WeakData(InitializerType(GetContext(), GarbageCollectedObject)), [](const WeakCallbackInfo<WeakData>& data) {
-			auto Parameter = data.GetParameter();
+	/** Weak callback needs no allocation, as its payload lives in the internal fields of the wrapper */
+	template <typename T>
+	void SetWeakWrapper(UniquePersistent<Value>& Handle, Local<Value> Wrapper, T* GarbageCollectedObject)
+	{
+		auto Object = Wrapper.As<v8::Object>();
+		Object->SetAlignedPointerInInternalField(0, GarbageCollectedObject);
+		Object->SetAlignedPointerInInternalField(1, GetContext());
 
-			auto Context = Parameter->Key;
-			auto Self = static_cast<FJavascriptIsolateImplementation*>(Context->Environment.Get());
-			Self->OnGarbageCollectedByV8(Context, Parameter->Value);
+		Handle.SetWeak(this, [](const WeakCallbackInfo<FJavascriptIsolateImplementation>& data) {
+			auto Context = reinterpret_cast<FJavascriptContext*>(data.GetInternalField(1));
+			data.GetParameter()->OnGarbageCollectedByV8(Context, reinterpret_cast<T*>(data.GetInternalField(0)));
+		}, WeakCallbackType::kInternalFields);
+	}
 
-			delete Parameter;
+	/** Templates are isolate-wide, so the struct itself is all the callback needs */
+	template <typename StructT>
+	void SetWeakTemplate(UniquePersistent<FunctionTemplate>& Handle, StructT* Struct)
+	{
+		Handle.SetWeak(Struct, [](const WeakCallbackInfo<StructT>& data) {
+			GetSelf(data.GetIsolate())->OnTemplateGarbageCollectedByV8(data.GetParameter());
 		}, WeakCallbackType::kParameter);
-#endif
 	}
 
 	template <typename StructT>
@@ -2625,7 +3458,7 @@ public:
 		// Track this class from v8 gc.
 		auto& result = classMap.Add(ueClass,
 			UniquePersistent<FunctionTemplate>(isolate_, classTemplate));
-		SetWeak(result, ueClass);
+		SetWeakTemplate(result, ueClass);
 	}
 
 	virtual void RegisterClass(UClass* Class, Local<FunctionTemplate> Template) override
@@ -2636,41 +3469,56 @@ public:
 	void RegisterObject(UObject* UnrealObject, Local<Value> value)
 	{
 		auto& result = GetContext()->ObjectToObjectMap.Add(UnrealObject, UniquePersistent<Value>(isolate_, value));
-		SetWeak(result, UnrealObject);
+		SetWeakWrapper(result, value, UnrealObject);
 	}
 
-	void RegisterScriptStructInstance(TSharedPtr<FStructMemoryInstance> MemoryObject, Local<Value> value)
+	void RegisterScriptStructInstance(const TRefCountPtr<FStructMemoryInstance>& MemoryObject, Local<Value> value)
 	{
 		auto context = GetContext();
+		if (!context->MemoryToObjectMap.Contains(MemoryObject))
+		{
+			FExternalMemory::Adjust(isolate_, MemoryObject->GetOwnedSize());
+		}
 		auto& result = context->MemoryToObjectMap.Add(MemoryObject, UniquePersistent<Value>(isolate_, value));
-		SetWeak(result, MemoryObject.Get());
+		SetWeakWrapper(result, value, MemoryObject.GetReference());
 	}
 
 	void OnGarbageCollectedByV8(FJavascriptContext* Context, FStructMemoryInstance* Memory)
 	{
+		// Removal may release the last reference
+		auto OwnedSize = Memory->GetOwnedSize();
+
 		// We should keep ourselves clean
-		Context->MemoryToObjectMap.Remove(Memory->AsShared());
+		if (Context->MemoryToObjectMap.Remove(Memory))
+		{
+			FExternalMemory::Adjust(isolate_, -OwnedSize);
+		}
 	}
 
 	void OnGarbageCollectedByV8(FJavascriptContext* Context, UObject* Object)
 	{
-		if (auto klass = Cast<UClass>(Object))
-		{
-			ClassToFunctionTemplateMap.Remove(klass);
-		}
-
 		Context->ObjectToObjectMap.Remove(Object);
 	}
 
+	void OnTemplateGarbageCollectedByV8(UClass* Class)
+	{
+		ClassToFunctionTemplateMap.Remove(Class);
+	}
+
+	void OnTemplateGarbageCollectedByV8(UScriptStruct* Struct)
+	{
+		ScriptStructToFunctionTemplateMap.Remove(Struct);
+	}
+
 	static FJavascriptIsolateImplementation* GetSelf(Isolate* isolate)
 	{
 		return reinterpret_cast<FJavascriptIsolateImplementation*>(isolate->GetData(0));
 	}
 };
 
-FJavascriptIsolate* FJavascriptIsolate::Create()
+FJavascriptIsolate* FJavascriptIsolate::Create(const FJavascriptIsolateParams& Params)
 {
-	return new FJavascriptIsolateImplementation();
+	return new FJavascriptIsolateImplementation(Params);
 }
 
 Local<Value> FJavascriptIsolate::ReadProperty(Isolate* isolate, UProperty* Property, uint8* Buffer, const IPropertyOwner& Owner)
@@ -2686,7 +3534,6 @@ void FJavascriptIsolate::WriteProperty(Isolate* isolate, UProperty* Property, ui
 void FPendingClassConstruction::Finalize(FJavascriptIsolate* Isolate, UObject* UnrealObject)
 {
 	static_cast<FJavascriptIsolateImplementation*>(Isolate)->RegisterObject(UnrealObject, Object);
-	Object->SetAlignedPointerInInternalField(0, UnrealObject);
 }
 
 Local<Value> FJavascriptIsolate::ExportStructInstance(Isolate* isolate, UScriptStruct* Struct, uint8* Buffer, const IPropertyOwner& Owner)
@@ -2783,4 +3630,12 @@ void FJavascriptFunction::Execute(UScriptStruct* Struct, void* Buffer)
 	}
 }
 
+void UJavascriptLatentAction::Resume(int32 Linkage)
+{
+	if (JavascriptIsolate)
+	{
+		static_cast<FJavascriptIsolateImplementation*>(JavascriptIsolate)->OnLatentActionCompleted(Linkage);
+	}
+}
+
 PRAGMA_ENABLE_SHADOW_VARIABLE_WARNINGS
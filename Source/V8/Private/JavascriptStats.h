@@ -8,6 +8,16 @@ DECLARE_CYCLE_STAT_EXTERN(TEXT("IncrementalMarking"), STAT_IncrementalMarking, S
 DECLARE_CYCLE_STAT_EXTERN(TEXT("ProcessWeakCallbacks"), STAT_ProcessWeakCallbacks, STATGROUP_Javascript, V8_API);
 
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Idle task"), STAT_V8IdleTask, STATGROUP_Javascript, V8_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Idle GC"), STAT_V8IdleGarbageCollection, STATGROUP_Javascript, V8_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Idle time granted (ms)"), STAT_V8IdleTimeGranted, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Idle GC notifications"), STAT_V8IdleNotifications, STATGROUP_Javascript, V8_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Background task"), STAT_V8BackgroundTask, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Background tasks queued"), STAT_V8BackgroundTasksQueued, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Code cache hits"), STAT_V8CodeCacheHits, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Code cache rejected"), STAT_V8CodeCacheRejected, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Code cache produced"), STAT_V8CodeCacheProduced, STATGROUP_Javascript, V8_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("JSON decode"), STAT_JsonDecode, STATGROUP_Javascript, V8_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("JSON parse"), STAT_JsonParse, STATGROUP_Javascript, V8_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Delegate"), STAT_JavascriptDelegate, STATGROUP_Javascript, V8_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Proxy"), STAT_JavascriptProxy, STATGROUP_Javascript, V8_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("get"), STAT_JavascriptPropertyGet, STATGROUP_Javascript, V8_API);
@@ -22,3 +32,11 @@ DECLARE_MEMORY_STAT_EXTERN(TEXT("OldSpace"), STAT_OldSpace, STATGROUP_Javascript
 DECLARE_MEMORY_STAT_EXTERN(TEXT("CodeSpace"), STAT_CodeSpace, STATGROUP_Javascript, V8_API);
 DECLARE_MEMORY_STAT_EXTERN(TEXT("MapSpace"), STAT_MapSpace, STATGROUP_Javascript, V8_API);
 DECLARE_MEMORY_STAT_EXTERN(TEXT("LoSpace"), STAT_LoSpace, STATGROUP_Javascript, V8_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("External"), STAT_JavascriptExternalMemory, STATGROUP_Javascript, V8_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("ArrayBuffer live"), STAT_ArrayBufferLive, STATGROUP_Javascript, V8_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("ArrayBuffer peak"), STAT_ArrayBufferPeak, STATGROUP_Javascript, V8_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("ArrayBuffer pooled"), STAT_ArrayBufferPooled, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ArrayBuffer allocations"), STAT_ArrayBufferAllocations, STATGROUP_Javascript, V8_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ArrayBuffer allocated bytes"), STAT_ArrayBufferAllocatedBytes, STATGROUP_Javascript, V8_API);
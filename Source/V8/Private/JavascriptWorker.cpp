@@ -0,0 +1,440 @@
+PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
+
+#include "JavascriptWorker.h"
+#include "Translator.h"
+#include "Exception.h"
+#include "Helpers.h"
+#include "FileHelper.h"
+#include "Paths.h"
+#include "IV8.h"
+
+THIRD_PARTY_INCLUDES_START
+#include <libplatform/libplatform.h>
+THIRD_PARTY_INCLUDES_END
+
+using namespace v8;
+
+namespace
+{
+	class FSerializerDelegate : public ValueSerializer::Delegate
+	{
+	public:
+		FSerializerDelegate(Isolate* InIsolate, TArray<TRefCountPtr<FSharedMemoryBlock>>& InSharedBlocks, FPooledArrayBufferAllocator* InAllocator)
+			: isolate_(InIsolate), SharedBlocks(InSharedBlocks), Allocator(InAllocator)
+		{}
+
+		virtual void ThrowDataCloneError(Local<String> message) override
+		{
+			isolate_->ThrowException(Exception::Error(message));
+		}
+
+		virtual Maybe<uint32_t> GetSharedArrayBufferId(Isolate* isolate, Local<SharedArrayBuffer> Buffer) override
+		{
+			TRefCountPtr<FSharedMemoryBlock> Block;
+			if (Buffer->IsExternal())
+			{
+				Block = FSharedMemoryBlock::Find(Buffer->GetContents().Data());
+				if (!Block.IsValid())
+				{
+					FIsolateHelper(isolate).Throw(TEXT("SharedArrayBuffer over foreign memory cannot be posted"));
+					return Nothing<uint32_t>();
+				}
+			}
+			else
+			{
+				// Created by script; from now on the block owns its memory, which outlives the allocator of this isolate
+				auto Contents = Buffer->Externalize();
+				const bool bLazyZero = Allocator->IsLazyZero();
+				Allocator->Disown(Contents.ByteLength());
+
+				Block = FSharedMemoryBlock::Adopt(Contents.Data(), Contents.ByteLength(), [bLazyZero](void* Data, size_t Size) {
+					FPooledArrayBufferAllocator::FreeUnpooled(Data, Size, bLazyZero);
+				});
+				Block->Attach(isolate, Buffer);
+			}
+
+			auto Index = SharedBlocks.IndexOfByKey(Block);
+			if (Index == INDEX_NONE)
+			{
+				Index = SharedBlocks.Add(Block);
+			}
+			return Just<uint32_t>(Index);
+		}
+
+		virtual void* ReallocateBufferMemory(void* old_buffer, size_t size, size_t* actual_size) override
+		{
+			*actual_size = size;
+			return FMemory::Realloc(old_buffer, size);
+		}
+
+		virtual void FreeBufferMemory(void* buffer) override
+		{
+			FMemory::Free(buffer);
+		}
+
+	private:
+		Isolate* isolate_;
+		TArray<TRefCountPtr<FSharedMemoryBlock>>& SharedBlocks;
+		FPooledArrayBufferAllocator* Allocator;
+	};
+}
+
+FJavascriptMessage::~FJavascriptMessage()
+{
+	for (const auto& Buffer : ArrayBuffers)
+	{
+		Allocator->Free(Buffer.Data, Buffer.Length);
+	}
+}
+
+TUniquePtr<FJavascriptMessage> FJavascriptMessage::Serialize(Isolate* isolate, Local<Context> context, Local<Value> Value, Local<Value> TransferList, FPooledArrayBufferAllocator* Allocator)
+{
+	FIsolateHelper I(isolate);
+
+	auto Message = MakeUnique<FJavascriptMessage>();
+	Message->Allocator = Allocator;
+
+	FSerializerDelegate Delegate(isolate, Message->SharedBlocks, Allocator);
+	ValueSerializer Serializer(isolate, &Delegate);
+
+	TArray<Local<ArrayBuffer>> Transfers;
+	if (!TransferList.IsEmpty() && TransferList->IsArray())
+	{
+		auto Array = TransferList.As<v8::Array>();
+		for (uint32 Index = 0; Index < Array->Length(); ++Index)
+		{
+			auto Element = Array->Get(Index);
+
+			// Buffers over memory which V8 does not own (memory.access) cannot change hands
+			if (!Element->IsArrayBuffer() || Element.As<ArrayBuffer>()->IsExternal() || !Element.As<ArrayBuffer>()->IsNeuterable())
+			{
+				I.Throw(TEXT("Only ArrayBuffers allocated by scripts can be transferred"));
+				return nullptr;
+			}
+
+			Serializer.TransferArrayBuffer(Transfers.Num(), Element.As<ArrayBuffer>());
+			Transfers.Add(Element.As<ArrayBuffer>());
+		}
+	}
+	else if (!TransferList.IsEmpty() && !TransferList->IsUndefined())
+	{
+		I.Throw(TEXT("Transfer list should be an array"));
+		return nullptr;
+	}
+
+	Serializer.WriteHeader();
+	if (Serializer.WriteValue(context, Value).IsNothing())
+	{
+		return nullptr;
+	}
+
+	auto Buffer = Serializer.Release();
+	Message->Data.Append(Buffer.first, Buffer.second);
+	FMemory::Free(Buffer.first);
+
+	for (auto Transfer : Transfers)
+	{
+		auto Contents = Transfer->Externalize();
+		Transfer->Neuter();
+
+		Message->ArrayBuffers.Add({ Contents.Data(), Contents.ByteLength() });
+	}
+
+	return Message;
+}
+
+MaybeLocal<Value> FJavascriptMessage::Deserialize(Isolate* isolate, Local<Context> context)
+{
+	ValueDeserializer Deserializer(isolate, Data.GetData(), Data.Num());
+	if (Deserializer.ReadHeader(context).IsNothing())
+	{
+		return MaybeLocal<Value>();
+	}
+
+	for (int32 Index = 0; Index < ArrayBuffers.Num(); ++Index)
+	{
+		Deserializer.TransferArrayBuffer(Index, ArrayBuffer::New(isolate, ArrayBuffers[Index].Data, ArrayBuffers[Index].Length, ArrayBufferCreationMode::kInternalized));
+	}
+
+	for (int32 Index = 0; Index < SharedBlocks.Num(); ++Index)
+	{
+		Deserializer.TransferSharedArrayBuffer(Index, SharedBlocks[Index]->Bind(isolate));
+	}
+
+	// Receiving isolate frees them from now on
+	ArrayBuffers.Empty();
+
+	return Deserializer.ReadValue(context);
+}
+
+FJavascriptWorker::FJavascriptWorker(const FString& InFilename, const FPooledArrayBufferAllocator& OwnerAllocator)
+	: Filename(InFilename)
+{
+	// Transferred buffers are freed by the allocator of the receiving side
+	Allocator.Configure(OwnerAllocator);
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+}
+
+FJavascriptWorker::~FJavascriptWorker()
+{
+	Terminate();
+
+	if (Thread)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+	}
+
+	FJavascriptMessage* Message = nullptr;
+	while (Inbox.Dequeue(Message)) delete Message;
+	while (Outbox.Dequeue(Message)) delete Message;
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+}
+
+void FJavascriptWorker::Start()
+{
+	static int32 NumWorkers = 0;
+	Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("JavascriptWorker%d"), NumWorkers++), IV8::ThreadStackSize);
+	if (!Thread)
+	{
+		bFinished = true;
+	}
+}
+
+void FJavascriptWorker::Terminate()
+{
+	bStopping = true;
+
+	{
+		FScopeLock Lock(&IsolateLock);
+		if (isolate_)
+		{
+			isolate_->TerminateExecution();
+		}
+	}
+
+	WakeEvent->Trigger();
+}
+
+void FJavascriptWorker::PostMessage(TUniquePtr<FJavascriptMessage> Message)
+{
+	Inbox.Enqueue(Message.Release());
+	WakeEvent->Trigger();
+}
+
+bool FJavascriptWorker::ReceiveMessage(TUniquePtr<FJavascriptMessage>& OutMessage)
+{
+	FJavascriptMessage* Message = nullptr;
+	if (Outbox.Dequeue(Message))
+	{
+		OutMessage.Reset(Message);
+		return true;
+	}
+	return false;
+}
+
+uint32 FJavascriptWorker::Run()
+{
+	Isolate::CreateParams params;
+	params.array_buffer_allocator = &Allocator;
+
+	auto isolate = Isolate::New(params);
+	{
+		FScopeLock Lock(&IsolateLock);
+		isolate_ = isolate;
+	}
+	IV8::Get().SetForegroundTaskEvent(isolate, WakeEvent);
+
+	if (!bStopping)
+	{
+		Isolate::Scope isolate_scope(isolate);
+		HandleScope handle_scope(isolate);
+
+		auto context = Context::New(isolate, nullptr, CreateGlobalTemplate());
+		Context::Scope context_scope(context);
+
+		context->Global()->Set(V8_KeywordString(isolate, "self"), context->Global());
+
+		if (RunFile(context, Filename))
+		{
+			auto platform = reinterpret_cast<v8::Platform*>(IV8::Get().GetV8Platform());
+
+			while (!bStopping)
+			{
+				DispatchMessages(context);
+
+				while (v8::platform::PumpMessageLoop(platform, isolate)) {}
+
+				// Messages, termination and foreground tasks posted by V8 wake us
+				WakeEvent->Wait(IV8::Get().GetForegroundTaskWaitTime(isolate));
+			}
+		}
+	}
+
+	IV8::Get().SetForegroundTaskEvent(isolate, nullptr);
+	{
+		FScopeLock Lock(&IsolateLock);
+		isolate_ = nullptr;
+	}
+	isolate->Dispose();
+
+	bFinished = true;
+	return 0;
+}
+
+void FJavascriptWorker::DispatchMessages(Local<Context> context)
+{
+	auto isolate = context->GetIsolate();
+
+	FJavascriptMessage* RawMessage = nullptr;
+	while (!bStopping && Inbox.Dequeue(RawMessage))
+	{
+		TUniquePtr<FJavascriptMessage> Message(RawMessage);
+
+		HandleScope handle_scope(isolate);
+
+		TryCatch try_catch(isolate);
+
+		auto Handler = context->Global()->Get(V8_KeywordString(isolate, "onmessage"));
+		if (Handler.IsEmpty() || !Handler->IsFunction())
+		{
+			continue;
+		}
+
+		Local<Value> Data;
+		if (Message->Deserialize(isolate, context).ToLocal(&Data))
+		{
+			auto Event = Object::New(isolate);
+			Event->Set(V8_KeywordString(isolate, "data"), Data);
+
+			Local<Value> Args[] = { Event };
+			Handler.As<Function>()->Call(context->Global(), 1, Args);
+		}
+
+		if (try_catch.HasCaught() && !try_catch.HasTerminated())
+		{
+			FV8Exception::Report(try_catch);
+		}
+	}
+}
+
+bool FJavascriptWorker::RunFile(Local<Context> context, const FString& Path)
+{
+	auto isolate = context->GetIsolate();
+
+	FString Script;
+	if (!FFileHelper::LoadFileToString(Script, *Path))
+	{
+		UE_LOG(Javascript, Error, TEXT("Worker script not found: %s"), *Path);
+		return false;
+	}
+
+	auto ScriptDir = FPaths::GetPath(Path);
+	auto Text = FString::Printf(
+		TEXT("(function (global,__filename,__dirname) { %s\n;}(this,'%s','%s'));"),
+		*Script, *Path, *ScriptDir
+	);
+
+	TryCatch try_catch(isolate);
+
+	ScriptOrigin origin(V8_String(isolate, Path));
+	auto script = Script::Compile(V8_String(isolate, Text), &origin);
+	if (!script.IsEmpty())
+	{
+		script->Run();
+	}
+
+	if (try_catch.HasCaught())
+	{
+		if (!try_catch.HasTerminated())
+		{
+			FV8Exception::Report(try_catch);
+		}
+		return false;
+	}
+
+	return true;
+}
+
+Local<ObjectTemplate> FJavascriptWorker::CreateGlobalTemplate()
+{
+	auto isolate = isolate_;
+	FIsolateHelper I(isolate);
+
+	auto GlobalTemplate = ObjectTemplate::New(isolate);
+
+	// console
+	auto ConsoleTemplate = ObjectTemplate::New(isolate);
+
+	ConsoleTemplate->Set(I.Keyword("log"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		UE_LOG(Javascript, Log, TEXT("%s"), *StringFromArgs(info));
+	}));
+
+	ConsoleTemplate->Set(I.Keyword("warn"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		UE_LOG(Javascript, Warning, TEXT("%s"), *StringFromArgs(info));
+	}));
+
+	ConsoleTemplate->Set(I.Keyword("info"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		UE_LOG(Javascript, Display, TEXT("%s"), *StringFromArgs(info));
+	}));
+
+	ConsoleTemplate->Set(I.Keyword("error"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		UE_LOG(Javascript, Error, TEXT("%s"), *StringFromArgs(info));
+	}));
+
+	GlobalTemplate->Set(I.Keyword("console"), ConsoleTemplate);
+
+	// memory.shared(name, size), as in the owner isolate
+	auto MemoryTemplate = ObjectTemplate::New(isolate);
+	MemoryTemplate->Set(I.Keyword("shared"), I.FunctionTemplate(&FSharedMemoryBlock::OpenNamed));
+	MemoryTemplate->Set(I.Keyword("releaseShared"), I.FunctionTemplate(&FSharedMemoryBlock::ReleaseShared));
+	GlobalTemplate->Set(I.Keyword("memory"), MemoryTemplate);
+
+	GlobalTemplate->Set(I.Keyword("postMessage"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		auto Worker = reinterpret_cast<FJavascriptWorker*>((Local<External>::Cast(info.Data()))->Value());
+		auto isolate = info.GetIsolate();
+
+		auto Message = FJavascriptMessage::Serialize(isolate, isolate->GetCurrentContext(), info[0], info[1], &Worker->Allocator);
+		if (Message.IsValid())
+		{
+			Worker->Outbox.Enqueue(Message.Release());
+		}
+	}, this));
+
+	GlobalTemplate->Set(I.Keyword("close"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		auto Worker = reinterpret_cast<FJavascriptWorker*>((Local<External>::Cast(info.Data()))->Value());
+		Worker->bStopping = true;
+	}, this));
+
+	// Paths are relative to the worker script
+	GlobalTemplate->Set(I.Keyword("importScripts"), I.FunctionTemplate([](const FunctionCallbackInfo<Value>& info)
+	{
+		auto Worker = reinterpret_cast<FJavascriptWorker*>((Local<External>::Cast(info.Data()))->Value());
+		auto context = info.GetIsolate()->GetCurrentContext();
+
+		for (int32 Index = 0; Index < info.Length(); ++Index)
+		{
+			auto Path = FPaths::ConvertRelativePathToFull(FPaths::GetPath(Worker->Filename), StringFromV8(info[Index]));
+			if (!Worker->RunFile(context, Path))
+			{
+				if (!info.GetIsolate()->IsExecutionTerminating())
+				{
+					FIsolateHelper(info.GetIsolate()).Throw(FString::Printf(TEXT("Failed to import %s"), *Path));
+				}
+				return;
+			}
+		}
+	}, this));
+
+	return GlobalTemplate;
+}
+
+PRAGMA_ENABLE_SHADOW_VARIABLE_WARNINGS
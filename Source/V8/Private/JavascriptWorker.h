@@ -0,0 +1,86 @@
+#pragma once
+
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Containers/Queue.h"
+#include "PooledArrayBufferAllocator.h"
+#include "SharedMemoryBlock.h"
+
+/**
+* A value serialized by one isolate for another; ArrayBuffers in the transfer list move along without being copied.
+* SharedArrayBuffers are never copied either: the receiver gets one over the same memory.
+*/
+struct FJavascriptMessage
+{
+	~FJavascriptMessage();
+
+	/** Returns null with an exception thrown in isolate when Value cannot be cloned */
+	static TUniquePtr<FJavascriptMessage> Serialize(v8::Isolate* isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> Value, v8::Local<v8::Value> TransferList, FPooledArrayBufferAllocator* Allocator);
+
+	/** Transferred buffers are handed over to isolate, whose allocator has to be configured like the sender's */
+	v8::MaybeLocal<v8::Value> Deserialize(v8::Isolate* isolate, v8::Local<v8::Context> context);
+
+private:
+	struct FTransferredBuffer
+	{
+		void* Data;
+		size_t Length;
+	};
+
+	TArray<uint8> Data;
+	TArray<FTransferredBuffer> ArrayBuffers;
+	TArray<TRefCountPtr<FSharedMemoryBlock>> SharedBlocks;
+
+	/** Frees transferred buffers which never got delivered */
+	FPooledArrayBufferAllocator* Allocator{ nullptr };
+};
+
+/**
+* Runs a script in its own isolate on a dedicated thread.
+* Its global has no access to engine objects; it talks to its owner through postMessage/onmessage only.
+*/
+class FJavascriptWorker : public FRunnable
+{
+public:
+	FJavascriptWorker(const FString& InFilename, const FPooledArrayBufferAllocator& OwnerAllocator);
+	~FJavascriptWorker();
+
+	void Start();
+
+	/** Stops the script as soon as possible; messages not yet received are dropped */
+	void Terminate();
+
+	/** Whether the thread has exited, after close(), terminate() or a failure to start */
+	bool IsFinished() const { return bFinished; }
+
+	void PostMessage(TUniquePtr<FJavascriptMessage> Message);
+	bool ReceiveMessage(TUniquePtr<FJavascriptMessage>& OutMessage);
+
+	// Begin FRunnable interface.
+	virtual uint32 Run() override;
+	// End FRunnable interface.
+
+private:
+	FString Filename;
+
+	FPooledArrayBufferAllocator Allocator;
+
+	/** Valid while the thread runs; guarded, as Terminate may come from the owner thread */
+	v8::Isolate* isolate_{ nullptr };
+	FCriticalSection IsolateLock;
+
+	TQueue<FJavascriptMessage*, EQueueMode::Spsc> Inbox;
+	TQueue<FJavascriptMessage*, EQueueMode::Spsc> Outbox;
+
+	FEvent* WakeEvent{ nullptr };
+	FRunnableThread* Thread{ nullptr };
+
+	FThreadSafeBool bStopping;
+	FThreadSafeBool bFinished;
+
+	v8::Local<v8::ObjectTemplate> CreateGlobalTemplate();
+	bool RunFile(v8::Local<v8::Context> context, const FString& Path);
+	void DispatchMessages(v8::Local<v8::Context> context);
+};
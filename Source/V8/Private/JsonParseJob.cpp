@@ -0,0 +1,386 @@
+PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
+
+#include "JsonParseJob.h"
+#include "ScriptArchive.h"
+#include "FileHelper.h"
+#include "JavascriptStats.h"
+#include "Translator.h"
+
+using namespace v8;
+
+namespace
+{
+	/** Takes over the text, which V8 releases along with the string */
+	class FOneByteJsonResource : public String::ExternalOneByteStringResource
+	{
+	public:
+		FOneByteJsonResource(TArray<uint8>&& InText)
+			: Text(MoveTemp(InText))
+		{}
+
+		virtual const char* data() const override { return reinterpret_cast<const char*>(Text.GetData()); }
+		virtual size_t length() const override { return Text.Num(); }
+
+	private:
+		TArray<uint8> Text;
+	};
+
+	class FTwoByteJsonResource : public String::ExternalStringResource
+	{
+	public:
+		FTwoByteJsonResource(TArray<uint16>&& InText)
+			: Text(MoveTemp(InText))
+		{}
+
+		virtual const uint16_t* data() const override { return Text.GetData(); }
+		virtual size_t length() const override { return Text.Num(); }
+
+	private:
+		TArray<uint16> Text;
+	};
+
+	/** Nesting this deep is refused rather than left to overflow V8's stack */
+	const int32 MaxDepth = 4096;
+}
+
+void FJsonParseJob::Run()
+{
+	SCOPE_CYCLE_COUNTER(STAT_JsonDecode);
+
+	if (Read() && Validate())
+	{
+		Decode();
+	}
+}
+
+bool FJsonParseJob::Load()
+{
+	SCOPE_CYCLE_COUNTER(STAT_JsonDecode);
+
+	if (!Read())
+	{
+		return false;
+	}
+	Decode();
+	return true;
+}
+
+bool FJsonParseJob::Read()
+{
+	if (!Filename.IsEmpty())
+	{
+		// Archived text is ASCII or UTF-8 either way
+		if (auto Entry = FScriptArchive::FindFile(Filename))
+		{
+			Utf8.Append(Entry->Source, Entry->SourceSize);
+		}
+		else if (!FFileHelper::LoadFileToArray(Utf8, *Filename, FILEREAD_Silent))
+		{
+			Error = FString::Printf(TEXT("Cannot read %s"), *Filename);
+			return false;
+		}
+	}
+
+	if (Utf8.Num() >= 3 && Utf8[0] == 0xEF && Utf8[1] == 0xBB && Utf8[2] == 0xBF)
+	{
+		Utf8.RemoveAt(0, 3, false);
+	}
+	return true;
+}
+
+bool FJsonParseJob::Validate()
+{
+	const uint8* Begin = Utf8.GetData();
+	const uint8* End = Begin + Utf8.Num();
+	const uint8* Cursor = Begin;
+
+	auto Fail = [&](const TCHAR* What)
+	{
+		Error = FString::Printf(TEXT("%s at position %d"), What, (int32)(Cursor - Begin));
+		return false;
+	};
+
+	auto SkipWhitespace = [&]()
+	{
+		while (Cursor < End && (*Cursor == ' ' || *Cursor == '\t' || *Cursor == '\n' || *Cursor == '\r'))
+		{
+			++Cursor;
+		}
+	};
+
+	auto Digits = [&]()
+	{
+		auto Start = Cursor;
+		while (Cursor < End && *Cursor >= '0' && *Cursor <= '9')
+		{
+			++Cursor;
+		}
+		return Cursor > Start;
+	};
+
+	// Containers entered so far, '{' or '['
+	TArray<uint8, TInlineAllocator<64>> Stack;
+	// Whether the next string names a property
+	bool bKey = false;
+
+	for (;;)
+	{
+		// A value
+		SkipWhitespace();
+		if (Cursor == End)
+		{
+			return Fail(TEXT("Unexpected end of JSON"));
+		}
+
+		auto Token = *Cursor;
+		if (Token == '{' || Token == '[')
+		{
+			if (Stack.Num() == MaxDepth)
+			{
+				return Fail(TEXT("JSON nested too deep"));
+			}
+			Stack.Add(Token);
+			++Cursor;
+
+			SkipWhitespace();
+			if (Cursor < End && *Cursor == (Token == '{' ? '}' : ']'))
+			{
+				Stack.Pop(false);
+				++Cursor;
+			}
+			else
+			{
+				bKey = Token == '{';
+				continue;
+			}
+		}
+		else if (bKey && Token != '"')
+		{
+			return Fail(TEXT("Expected a property name"));
+		}
+		else if (Token == '"')
+		{
+			for (++Cursor;; ++Cursor)
+			{
+				if (Cursor == End)
+				{
+					return Fail(TEXT("Unterminated string in JSON"));
+				}
+				if (*Cursor == '"')
+				{
+					++Cursor;
+					break;
+				}
+				if (*Cursor < 0x20)
+				{
+					return Fail(TEXT("Bad control character in string literal"));
+				}
+				if (*Cursor == '\\')
+				{
+					if (++Cursor == End)
+					{
+						return Fail(TEXT("Unterminated string in JSON"));
+					}
+					if (*Cursor == 'u')
+					{
+						for (int32 Index = 0; Index < 4; ++Index)
+						{
+							if (++Cursor == End || !FChar::IsHexDigit(*Cursor))
+							{
+								return Fail(TEXT("Bad Unicode escape"));
+							}
+						}
+					}
+					else if (!FCStringAnsi::Strchr("\"\\/bfnrt", *Cursor))
+					{
+						return Fail(TEXT("Bad escaped character"));
+					}
+				}
+			}
+
+			// A property name is followed by its value
+			if (bKey)
+			{
+				SkipWhitespace();
+				if (Cursor == End || *Cursor != ':')
+				{
+					return Fail(TEXT("Expected ':' after property name"));
+				}
+				++Cursor;
+				bKey = false;
+				continue;
+			}
+		}
+		else if (Token == '-' || (Token >= '0' && Token <= '9'))
+		{
+			if (Token == '-')
+			{
+				++Cursor;
+			}
+			if (Cursor < End && *Cursor == '0')
+			{
+				++Cursor;
+			}
+			else if (!Digits())
+			{
+				return Fail(TEXT("No number after minus sign"));
+			}
+			if (Cursor < End && *Cursor == '.')
+			{
+				++Cursor;
+				if (!Digits())
+				{
+					return Fail(TEXT("Unterminated fractional number"));
+				}
+			}
+			if (Cursor < End && (*Cursor == 'e' || *Cursor == 'E'))
+			{
+				++Cursor;
+				if (Cursor < End && (*Cursor == '+' || *Cursor == '-'))
+				{
+					++Cursor;
+				}
+				if (!Digits())
+				{
+					return Fail(TEXT("Exponent part is missing a number"));
+				}
+			}
+		}
+		else
+		{
+			bool bLiteral = false;
+			for (auto Literal : { "true", "false", "null" })
+			{
+				auto Length = FCStringAnsi::Strlen(Literal);
+				if (End - Cursor >= Length && FMemory::Memcmp(Cursor, Literal, Length) == 0)
+				{
+					Cursor += Length;
+					bLiteral = true;
+					break;
+				}
+			}
+			if (!bLiteral)
+			{
+				return Fail(TEXT("Unexpected token"));
+			}
+		}
+
+		// What follows a value
+		for (;;)
+		{
+			SkipWhitespace();
+			if (Stack.Num() == 0)
+			{
+				return Cursor == End ? true : Fail(TEXT("Unexpected token after JSON"));
+			}
+			if (Cursor == End)
+			{
+				return Fail(TEXT("Unexpected end of JSON"));
+			}
+
+			auto Close = Stack.Last() == '{' ? '}' : ']';
+			if (*Cursor == Close)
+			{
+				Stack.Pop(false);
+				++Cursor;
+				continue;
+			}
+			if (*Cursor != ',')
+			{
+				return Fail(TEXT("Expected ',' or the end of a container"));
+			}
+			++Cursor;
+
+			bKey = Close == '}';
+			break;
+		}
+	}
+}
+
+void FJsonParseJob::Decode()
+{
+	bOneByte = true;
+	for (auto Byte : Utf8)
+	{
+		if (Byte >= 0x80)
+		{
+			bOneByte = false;
+			break;
+		}
+	}
+
+	// ASCII is Latin-1 already; anything else is widened to UTF-16
+	if (!bOneByte)
+	{
+		TwoByte.Reserve(Utf8.Num());
+
+		const uint8* Cursor = Utf8.GetData();
+		const uint8* End = Cursor + Utf8.Num();
+		while (Cursor < End)
+		{
+			uint32 Code = *Cursor++;
+			int32 Trailing = Code < 0x80 ? 0 : Code < 0xE0 ? 1 : Code < 0xF0 ? 2 : 3;
+			if (Code >= 0x80 && Code < 0xC0)
+			{
+				// Stray continuation byte
+				Code = 0xFFFD;
+			}
+			else if (Trailing)
+			{
+				Code &= 0x3F >> Trailing;
+				for (int32 Index = 0; Index < Trailing; ++Index)
+				{
+					if (Cursor == End || (*Cursor & 0xC0) != 0x80)
+					{
+						Code = 0xFFFD;
+						break;
+					}
+					Code = (Code << 6) | (*Cursor++ & 0x3F);
+				}
+			}
+
+			if (Code > 0x10FFFF)
+			{
+				TwoByte.Add(0xFFFD);
+			}
+			else if (Code >= 0x10000)
+			{
+				Code -= 0x10000;
+				TwoByte.Add(0xD800 + (Code >> 10));
+				TwoByte.Add(0xDC00 + (Code & 0x3FF));
+			}
+			else
+			{
+				TwoByte.Add(Code);
+			}
+		}
+		Utf8.Empty();
+	}
+}
+
+MaybeLocal<Value> FJsonParseJob::Parse(Local<Context> context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_JsonParse);
+
+	auto isolate = context->GetIsolate();
+
+	if (!Error.IsEmpty())
+	{
+		isolate->ThrowException(Exception::SyntaxError(V8_String(isolate, Error)));
+		return MaybeLocal<Value>();
+	}
+
+	MaybeLocal<String> Text = bOneByte
+		? String::NewExternalOneByte(isolate, new FOneByteJsonResource(MoveTemp(Utf8)))
+		: String::NewExternalTwoByte(isolate, new FTwoByteJsonResource(MoveTemp(TwoByte)));
+
+	Local<String> json;
+	if (!Text.ToLocal(&json))
+	{
+		isolate->ThrowException(Exception::RangeError(V8_String(isolate, "JSON text is too long")));
+		return MaybeLocal<Value>();
+	}
+	return JSON::Parse(context, json);
+}
+
+PRAGMA_ENABLE_SHADOW_VARIABLE_WARNINGS
@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+* JSON text read, checked and decoded off the game thread, which is left with building the value.
+* The decoded text is handed to V8 as an external string, so it is not copied again.
+*/
+struct FJsonParseJob
+{
+	/** File to read; when empty, Utf8 holds the text already */
+	FString Filename;
+	TArray<uint8> Utf8;
+
+	/** Settled with the value; empty for synchronous parses */
+	v8::Global<v8::Promise::Resolver> Resolver;
+	/** Module path the value is cached by, when it is a JSON module */
+	FString ModulePath;
+	FGraphEventRef Event;
+
+	/** Reads, validates and decodes; safe on any thread */
+	void Run();
+
+	/** Reads and decodes, leaving validation to V8; safe on any thread */
+	bool Load();
+
+	/** Builds the value on the thread which owns the isolate; throws within the isolate on failure */
+	v8::MaybeLocal<v8::Value> Parse(v8::Local<v8::Context> context);
+
+	/** Why Run failed; empty when the text is valid */
+	FString Error;
+
+private:
+	bool Read();
+	bool Validate();
+	void Decode();
+
+	bool bOneByte{ false };
+	TArray<uint16> TwoByte;
+};
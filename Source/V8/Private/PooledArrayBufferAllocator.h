@@ -0,0 +1,235 @@
+#pragma once
+
+#include "Containers/LockFreeList.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "JavascriptStats.h"
+
+/**
+* ArrayBuffer allocator which recycles small blocks through per size-class free lists.
+* Blocks larger than the biggest size class bypass the pool. With lazy zeroing, blocks over 1MB
+* come straight from the OS, whose pages are already zero-filled; smaller ones are not worth
+* a map and unmap each.
+*/
+class FPooledArrayBufferAllocator : public v8::ArrayBuffer::Allocator
+{
+public:
+	/** Size classes range from 16 bytes to 64KB */
+	enum
+	{
+		MinBlockSizeShift = 4,
+		MaxBlockSizeShift = 16,
+		NumSizeClasses = MaxBlockSizeShift - MinBlockSizeShift + 1,
+		/** Lazily zeroed blocks above 1MB come from the OS */
+		MinOSBlockSizeShift = 20
+	};
+
+	~FPooledArrayBufferAllocator()
+	{
+		Trim();
+	}
+
+	/** Should be called before the allocator is handed to an isolate */
+	void Configure(bool bInPool, bool bInLazyZero, int64 InMaxPooledBytes)
+	{
+		bPool = bInPool;
+		bLazyZero = bInLazyZero;
+		MaxPooledBytes = InMaxPooledBytes;
+	}
+
+	/** Allocators which exchange blocks have to agree on where large blocks come from */
+	void Configure(const FPooledArrayBufferAllocator& Other)
+	{
+		Configure(Other.bPool, Other.bLazyZero, Other.MaxPooledBytes);
+	}
+
+	/**
+	* Allocate |length| bytes. Return NULL if allocation is not successful.
+	* Memory should be initialized to zeroes.
+	*/
+	virtual void* Allocate(size_t length) override
+	{
+		return AllocateInternal(length, true);
+	}
+
+	/**
+	* Allocate |length| bytes. Return NULL if allocation is not successful.
+	* Memory does not have to be initialized.
+	*/
+	virtual void* AllocateUninitialized(size_t length) override
+	{
+		return AllocateInternal(length, false);
+	}
+
+	/**
+	* Free the memory block of size |length|, pointed to by |data|.
+	* That memory is guaranteed to be previously allocated by |Allocate|.
+	*/
+	virtual void Free(void* data, size_t length) override
+	{
+		OnFree(length);
+
+		auto SizeClass = GetSizeClass(length);
+		if (bLazyZero && IsOSBlock(length))
+		{
+			FPlatformMemory::BinnedFreeToOS(data, length);
+		}
+		else if (SizeClass != INDEX_NONE && bPool && PooledBytes.GetValue() + GetBlockSize(SizeClass) <= MaxPooledBytes)
+		{
+			PooledBytes.Add(GetBlockSize(SizeClass));
+			INC_MEMORY_STAT_BY(STAT_ArrayBufferPooled, GetBlockSize(SizeClass));
+
+			FreeLists[SizeClass].Push(data);
+		}
+		else
+		{
+			GMalloc->Free(data);
+		}
+	}
+
+	/** Releases all pooled blocks */
+	void Trim()
+	{
+		for (int32 SizeClass = 0; SizeClass < NumSizeClasses; ++SizeClass)
+		{
+			while (auto Block = FreeLists[SizeClass].Pop())
+			{
+				PooledBytes.Subtract(GetBlockSize(SizeClass));
+				DEC_MEMORY_STAT_BY(STAT_ArrayBufferPooled, GetBlockSize(SizeClass));
+
+				GMalloc->Free(Block);
+			}
+		}
+	}
+
+	/** Stops accounting a block which is going to be released by FreeUnpooled */
+	void Disown(size_t length)
+	{
+		OnFree(length);
+	}
+
+	/** Frees a block of an allocator which may be gone by now; the block does not return to any pool */
+	static void FreeUnpooled(void* data, size_t length, bool bLazyZero)
+	{
+		if (bLazyZero && IsOSBlock(length))
+		{
+			FPlatformMemory::BinnedFreeToOS(data, length);
+		}
+		else
+		{
+			GMalloc->Free(data);
+		}
+	}
+
+	bool IsLazyZero() const { return bLazyZero; }
+
+	int64 GetLiveBytes() const { return LiveBytes.GetValue(); }
+	int64 GetPeakBytes() const { return PeakBytes; }
+	int64 GetPooledBytes() const { return PooledBytes.GetValue(); }
+
+private:
+	bool bPool{ true };
+	bool bLazyZero{ true };
+	int64 MaxPooledBytes{ 16 * 1024 * 1024 };
+
+	TLockFreePointerListUnordered<void, PLATFORM_CACHE_LINE_SIZE> FreeLists[NumSizeClasses];
+
+	FThreadSafeCounter64 PooledBytes;
+	FThreadSafeCounter64 LiveBytes;
+	volatile int64 PeakBytes{ 0 };
+
+	static SIZE_T GetBlockSize(int32 SizeClass)
+	{
+		return SIZE_T(1) << (SizeClass + MinBlockSizeShift);
+	}
+
+	static bool IsOSBlock(size_t length)
+	{
+		return length > (SIZE_T(1) << MinOSBlockSizeShift);
+	}
+
+	/** Returns INDEX_NONE for large blocks */
+	static int32 GetSizeClass(size_t length)
+	{
+		if (length > GetBlockSize(NumSizeClasses - 1))
+		{
+			return INDEX_NONE;
+		}
+
+		return FMath::Max<int32>(FMath::CeilLogTwo64(length), MinBlockSizeShift) - MinBlockSizeShift;
+	}
+
+	void* AllocateInternal(size_t length, bool bZero)
+	{
+		void* Block = nullptr;
+
+		auto SizeClass = GetSizeClass(length);
+		if (SizeClass == INDEX_NONE)
+		{
+			if (bLazyZero && IsOSBlock(length))
+			{
+				// Fresh pages from the OS are zero-filled and get committed on first touch
+				Block = FPlatformMemory::BinnedAllocFromOS(length);
+				bZero = false;
+			}
+			else
+			{
+				Block = GMalloc->Malloc(length);
+			}
+		}
+		else if (!bPool)
+		{
+			Block = GMalloc->Malloc(length);
+		}
+		else
+		{
+			Block = FreeLists[SizeClass].Pop();
+			if (Block)
+			{
+				PooledBytes.Subtract(GetBlockSize(SizeClass));
+				DEC_MEMORY_STAT_BY(STAT_ArrayBufferPooled, GetBlockSize(SizeClass));
+			}
+			else
+			{
+				Block = GMalloc->Malloc(GetBlockSize(SizeClass));
+			}
+		}
+
+		if (Block)
+		{
+			if (bZero)
+			{
+				FMemory::Memzero(Block, length);
+			}
+
+			OnAllocate(length);
+		}
+
+		return Block;
+	}
+
+	void OnAllocate(size_t length)
+	{
+		auto Live = LiveBytes.Add(length) + length;
+
+		// Peak only grows; losing a race to a larger value is fine
+		for (int64 Peak = PeakBytes; Live > Peak; Peak = PeakBytes)
+		{
+			if (FPlatformAtomics::InterlockedCompareExchange(&PeakBytes, Live, Peak) == Peak)
+			{
+				SET_MEMORY_STAT(STAT_ArrayBufferPeak, Live);
+				break;
+			}
+		}
+
+		INC_MEMORY_STAT_BY(STAT_ArrayBufferLive, length);
+		INC_DWORD_STAT(STAT_ArrayBufferAllocations);
+		INC_DWORD_STAT_BY(STAT_ArrayBufferAllocatedBytes, length);
+	}
+
+	void OnFree(size_t length)
+	{
+		LiveBytes.Subtract(length);
+
+		DEC_MEMORY_STAT_BY(STAT_ArrayBufferLive, length);
+	}
+};
@@ -0,0 +1,338 @@
+PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
+
+#include "ScriptArchive.h"
+#include "FileManager.h"
+#include "FileHelper.h"
+#include "Paths.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "IV8.h"
+
+using namespace v8;
+
+namespace
+{
+	class FArchiveStringResource : public String::ExternalOneByteStringResource
+	{
+	public:
+		FArchiveStringResource(const uint8* InData, uint32 InLength)
+			: Data(InData), Length(InLength)
+		{}
+
+		virtual const char* data() const override { return reinterpret_cast<const char*>(Data); }
+		virtual size_t length() const override { return Length; }
+
+	private:
+		const uint8* Data;
+		uint32 Length;
+	};
+}
+
+TArray<TUniquePtr<FScriptArchive::FMountedArchive>>& FScriptArchive::GetArchives()
+{
+	static TArray<TUniquePtr<FMountedArchive>> Archives;
+	return Archives;
+}
+
+FCriticalSection& FScriptArchive::GetLock()
+{
+	static FCriticalSection Lock;
+	return Lock;
+}
+
+FString FScriptArchive::NormalizePath(const FString& Path)
+{
+	auto Result = FPaths::ConvertRelativePathToFull(Path);
+	FPaths::NormalizeFilename(Result);
+	FPaths::RemoveDuplicateSlashes(Result);
+	while (Result.EndsWith(TEXT("/")))
+	{
+		Result.RemoveAt(Result.Len() - 1);
+	}
+	return Result;
+}
+
+bool FScriptArchive::Mount(const FString& Filename)
+{
+	auto Archive = MakeUnique<FMountedArchive>();
+	if (!FFileHelper::LoadFileToArray(Archive->Data, *Filename, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	auto MountPoint = NormalizePath(FPaths::GetPath(Filename) / FPaths::GetBaseFilename(Filename));
+
+	FMemoryReader Reader(Archive->Data);
+
+	uint32 FileMagic = 0, FileVersion = 0, NumEntries = 0;
+	Reader << FileMagic << FileVersion << NumEntries;
+	if (FileMagic != Magic || FileVersion != Version)
+	{
+		UE_LOG(Javascript, Warning, TEXT("Not a script archive: %s"), *Filename);
+		return false;
+	}
+
+	const int64 TotalSize = Archive->Data.Num();
+	for (uint32 Index = 0; Index < NumEntries && !Reader.IsError(); ++Index)
+	{
+		uint16 PathLength = 0;
+		Reader << PathLength;
+
+		TArray<ANSICHAR> PathUtf8;
+		PathUtf8.AddZeroed(PathLength + 1);
+		Reader.Serialize(PathUtf8.GetData(), PathLength);
+
+		uint8 Encoding = 0;
+		uint64 SourceOffset = 0, CodeCacheOffset = 0;
+		uint32 SourceSize = 0, CodeCacheSize = 0;
+		FSHAHash Hash;
+		Reader << Encoding << SourceOffset << SourceSize << CodeCacheOffset << CodeCacheSize;
+		Reader.Serialize(Hash.Hash, sizeof(Hash.Hash));
+
+		if (Reader.IsError() || Encoding > (uint8)EEncoding::UTF8 || SourceOffset + SourceSize > (uint64)TotalSize || CodeCacheOffset + CodeCacheSize > (uint64)TotalSize)
+		{
+			UE_LOG(Javascript, Warning, TEXT("Malformed script archive: %s"), *Filename);
+			return false;
+		}
+
+		FEntry Entry;
+		Entry.Encoding = (EEncoding)Encoding;
+		Entry.Source = Archive->Data.GetData() + SourceOffset;
+		Entry.SourceSize = SourceSize;
+		Entry.CodeCache = CodeCacheSize ? Archive->Data.GetData() + CodeCacheOffset : nullptr;
+		Entry.CodeCacheSize = CodeCacheSize;
+		Entry.Hash = Hash;
+
+		auto Path = MountPoint / UTF8_TO_TCHAR(PathUtf8.GetData());
+		Archive->Files.Add(Path, Entry);
+
+		for (auto Directory = FPaths::GetPath(Path); Directory.Len() >= MountPoint.Len(); Directory = FPaths::GetPath(Directory))
+		{
+			Archive->Directories.Add(Directory);
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(Javascript, Warning, TEXT("Malformed script archive: %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(Javascript, Log, TEXT("Mounted script archive %s (%d files) at %s"), *Filename, Archive->Files.Num(), *MountPoint);
+
+	FScopeLock Lock(&GetLock());
+	GetArchives().Add(MoveTemp(Archive));
+	return true;
+}
+
+void FScriptArchive::UnmountAll()
+{
+	FScopeLock Lock(&GetLock());
+	GetArchives().Empty();
+}
+
+const FScriptArchive::FEntry* FScriptArchive::FindFile(const FString& Path)
+{
+	if (GetArchives().Num() == 0)
+	{
+		return nullptr;
+	}
+
+	auto Key = NormalizePath(Path);
+
+	FScopeLock Lock(&GetLock());
+	for (auto& Archive : GetArchives())
+	{
+		auto Entry = Archive->Files.Find(Key);
+		if (!Entry)
+		{
+			continue;
+		}
+
+		// Checked once, on first use
+		auto Verified = Archive->Verified.Find(Key);
+		if (!Verified)
+		{
+			FSHAHash Hash;
+			FSHA1::HashBuffer(Entry->Source, Entry->SourceSize, Hash.Hash);
+
+			Verified = &Archive->Verified.Add(Key, Hash == Entry->Hash);
+			if (!*Verified)
+			{
+				UE_LOG(Javascript, Error, TEXT("Script archive entry is corrupt: %s"), *Key);
+			}
+		}
+
+		return *Verified ? Entry : nullptr;
+	}
+	return nullptr;
+}
+
+bool FScriptArchive::HasDirectory(const FString& Path)
+{
+	if (GetArchives().Num() == 0)
+	{
+		return false;
+	}
+
+	auto Key = NormalizePath(Path);
+
+	FScopeLock Lock(&GetLock());
+	for (const auto& Archive : GetArchives())
+	{
+		if (Archive->Directories.Contains(Key))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FScriptArchive::LoadFileToString(FString& Result, const FString& Path)
+{
+	if (auto Entry = FindFile(Path))
+	{
+		Result = GetText(*Entry);
+		return true;
+	}
+	return FFileHelper::LoadFileToString(Result, *Path);
+}
+
+FString FScriptArchive::GetText(const FEntry& Entry)
+{
+	if (Entry.Encoding == EEncoding::UTF8)
+	{
+		FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Entry.Source), Entry.SourceSize);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	FString Result;
+	Result.GetCharArray().SetNumUninitialized(Entry.SourceSize + 1);
+	for (uint32 Index = 0; Index < Entry.SourceSize; ++Index)
+	{
+		Result.GetCharArray()[Index] = (TCHAR)Entry.Source[Index];
+	}
+	Result.GetCharArray()[Entry.SourceSize] = 0;
+	return Result;
+}
+
+Local<String> FScriptArchive::GetString(Isolate* isolate, const FEntry& Entry)
+{
+	if (Entry.Encoding == EEncoding::UTF8)
+	{
+		return String::NewFromUtf8(isolate, reinterpret_cast<const char*>(Entry.Source), NewStringType::kNormal, Entry.SourceSize).ToLocalChecked();
+	}
+
+	// V8 disposes the resource once the string is collected
+	return String::NewExternalOneByte(isolate, new FArchiveStringResource(Entry.Source, Entry.SourceSize)).ToLocalChecked();
+}
+
+bool FScriptArchive::Write(const FString& Directory)
+{
+	auto Root = NormalizePath(Directory);
+
+	TArray<FString> Files;
+	for (auto Extension : { TEXT("*.js"), TEXT("*.mjs"), TEXT("*.json") })
+	{
+		TArray<FString> Found;
+		IFileManager::Get().FindFilesRecursive(Found, *Root, Extension, true, false, false);
+		Files.Append(Found);
+	}
+
+	struct FPendingEntry
+	{
+		TArray<uint8> Path;
+		EEncoding Encoding;
+		TArray<uint8> Source;
+	};
+
+	TArray<FPendingEntry> Entries;
+	for (const auto& File : Files)
+	{
+		FString Text;
+		if (!FFileHelper::LoadFileToString(Text, *File))
+		{
+			UE_LOG(Javascript, Error, TEXT("Cannot read %s"), *File);
+			return false;
+		}
+
+		auto Relative = NormalizePath(File);
+		FPaths::MakePathRelativeTo(Relative, *(Root + TEXT("/")));
+
+		FTCHARToUTF8 Utf8(*Text);
+
+		// ASCII is the common case, and as Latin-1 it can be handed to V8 as it is
+		bool bAscii = true;
+		for (int32 Index = 0; Index < Utf8.Length() && bAscii; ++Index)
+		{
+			bAscii = (uint8)Utf8.Get()[Index] < 0x80;
+		}
+
+		FTCHARToUTF8 PathUtf8(*Relative);
+
+		auto& Entry = Entries[Entries.AddDefaulted()];
+		Entry.Path.Append(reinterpret_cast<const uint8*>(PathUtf8.Get()), PathUtf8.Length());
+		Entry.Encoding = bAscii ? EEncoding::Latin1 : EEncoding::UTF8;
+		Entry.Source.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	TArray<uint8> Index;
+	FMemoryWriter Writer(Index);
+
+	uint32 FileMagic = Magic, FileVersion = Version, NumEntries = Entries.Num();
+	Writer << FileMagic << FileVersion << NumEntries;
+
+	int64 IndexSize = Writer.Tell();
+	for (const auto& Entry : Entries)
+	{
+		IndexSize += sizeof(uint16) + Entry.Path.Num() + sizeof(uint8) + 2 * (sizeof(uint64) + sizeof(uint32)) + sizeof(FSHAHash::Hash);
+	}
+
+	uint64 Offset = IndexSize;
+	for (auto& Entry : Entries)
+	{
+		uint16 PathLength = Entry.Path.Num();
+		uint8 Encoding = (uint8)Entry.Encoding;
+		uint32 SourceSize = Entry.Source.Num();
+		uint64 CodeCacheOffset = 0;
+		uint32 CodeCacheSize = 0;
+
+		FSHAHash Hash;
+		FSHA1::HashBuffer(Entry.Source.GetData(), Entry.Source.Num(), Hash.Hash);
+
+		Writer << PathLength;
+		Writer.Serialize(Entry.Path.GetData(), PathLength);
+		Writer << Encoding << Offset << SourceSize << CodeCacheOffset << CodeCacheSize;
+		Writer.Serialize(Hash.Hash, sizeof(Hash.Hash));
+
+		Offset += SourceSize;
+	}
+
+	check(Writer.Tell() == IndexSize);
+
+	for (const auto& Entry : Entries)
+	{
+		Index.Append(Entry.Source);
+	}
+
+	auto Filename = Root + TEXT(".jsar");
+	if (!FFileHelper::SaveArrayToFile(Index, *Filename))
+	{
+		UE_LOG(Javascript, Error, TEXT("Cannot write %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(Javascript, Log, TEXT("Packed %d scripts into %s"), Entries.Num(), *Filename);
+	return true;
+}
+
+static FAutoConsoleCommand GJavascriptBuildScriptArchiveCommand(
+	TEXT("Javascript.BuildScriptArchive"),
+	TEXT("Packs the scripts of a directory into <directory>.jsar, which is mounted in its place on startup"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FScriptArchive::Write(Args.Num() ? Args[0] : FPaths::GameContentDir() / TEXT("Scripts"));
+	}));
+
+PRAGMA_ENABLE_SHADOW_VARIABLE_WARNINGS
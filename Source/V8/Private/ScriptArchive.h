@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Misc/SecureHash.h"
+
+/**
+* Scripts packed into a single file, which is read with one request and stays in memory until shutdown.
+* An archive named Foo.jsar is mounted onto the directory Foo next to it, and its files shadow the ones on disk.
+*
+* Layout, little endian:
+*   'JSAR', version, number of entries
+*   per entry: path relative to the mount point (uint16 length, UTF-8), encoding (uint8),
+*              source offset (uint64) and size (uint32), code cache offset (uint64) and size (uint32, 0 when there is none),
+*              SHA1 of the source
+*   payloads
+*/
+class FScriptArchive
+{
+public:
+	enum class EEncoding : uint8
+	{
+		Latin1,
+		UTF8
+	};
+
+	struct FEntry
+	{
+		EEncoding Encoding;
+		const uint8* Source;
+		uint32 SourceSize;
+		const uint8* CodeCache;
+		uint32 CodeCacheSize;
+		FSHAHash Hash;
+	};
+
+	/** Mounts the archive if it exists; false when it is missing or malformed */
+	static bool Mount(const FString& Filename);
+
+	/** Releases all archives; strings over their memory must be gone by now */
+	static void UnmountAll();
+
+	/** File within a mounted archive; null when there is none or its source fails the hash check */
+	static const FEntry* FindFile(const FString& Path);
+
+	static bool HasDirectory(const FString& Path);
+
+	/** Reads from an archive first and from disk otherwise */
+	static bool LoadFileToString(FString& Result, const FString& Path);
+
+	static FString GetText(const FEntry& Entry);
+
+	/** Latin-1 sources become external strings over the archive memory, so they are neither copied nor widened */
+	static v8::Local<v8::String> GetString(v8::Isolate* isolate, const FEntry& Entry);
+
+	/** Packs .js, .mjs and .json files under Directory into Directory.jsar */
+	static bool Write(const FString& Directory);
+
+private:
+	enum { Magic = 0x5241534a, Version = 1 };
+
+	struct FMountedArchive
+	{
+		TArray<uint8> Data;
+		TMap<FString, FEntry> Files;
+		TSet<FString> Directories;
+		/** Entries whose hash was checked, by path; false when it did not match */
+		TMap<FString, bool> Verified;
+	};
+
+	static TArray<TUniquePtr<FMountedArchive>>& GetArchives();
+	static FCriticalSection& GetLock();
+	static FString NormalizePath(const FString& Path);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Misc/SecureHash.h"
+#include "FileHelper.h"
+#include "Paths.h"
+#include "AsyncFileWriter.h"
+#include "JavascriptStats.h"
+
+/**
+* Code caches of compiled scripts, kept under Saved/Javascript/CodeCache.
+* A cache is keyed by the hash of the script source, or by a key the caller derived from it, and by V8's version tag, which covers the V8 version and flags.
+*/
+struct FScriptCodeCache
+{
+	/** Compiles Source, consuming its cache when there is one and producing the cache otherwise */
+	static v8::MaybeLocal<v8::Script> Compile(v8::Local<v8::Context> context, const FString& Text, v8::Local<v8::String> Source, v8::ScriptOrigin& Origin)
+	{
+		FTCHARToUTF8 Utf8(*Text);
+
+		uint8 Hash[20];
+		FSHA1::HashBuffer(Utf8.Get(), Utf8.Length(), Hash);
+
+		return CompileKeyed(context, BytesToHex(Hash, sizeof(Hash)), Source, Origin);
+	}
+
+	/** Same, with the key of a source whose hash is known already; an embedded cache is tried before the one on disk */
+	static v8::MaybeLocal<v8::Script> CompileKeyed(v8::Local<v8::Context> context, const FString& Key, v8::Local<v8::String> Source, v8::ScriptOrigin& Origin, const uint8* Embedded = nullptr, int32 EmbeddedSize = 0)
+	{
+		if (Embedded && EmbeddedSize > 0)
+		{
+			auto Cached = new v8::ScriptCompiler::CachedData(Embedded, EmbeddedSize);
+			v8::ScriptCompiler::Source ScriptSource(Source, Origin, Cached);
+
+			// V8 compiles from scratch on rejection, which is as good as it gets without compiling twice
+			auto Script = v8::ScriptCompiler::Compile(context, &ScriptSource, v8::ScriptCompiler::kConsumeCodeCache);
+			if (Cached->rejected)
+			{
+				INC_DWORD_STAT(STAT_V8CodeCacheRejected);
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_V8CodeCacheHits);
+			}
+			return Script;
+		}
+
+		auto Filename = GetFilename(Key);
+
+		TArray<uint8> Data;
+		if (FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+		{
+			// Source owns the descriptor; Data stays ours
+			auto Cached = new v8::ScriptCompiler::CachedData(Data.GetData(), Data.Num());
+			v8::ScriptCompiler::Source ScriptSource(Source, Origin, Cached);
+
+			auto Script = v8::ScriptCompiler::Compile(context, &ScriptSource, v8::ScriptCompiler::kConsumeCodeCache);
+			if (Cached->rejected)
+			{
+				// Written by another build or corrupted; the next compile produces a fresh one
+				INC_DWORD_STAT(STAT_V8CodeCacheRejected);
+				UE_LOG(Javascript, Verbose, TEXT("Code cache rejected: %s"), *Filename);
+
+				IFileManager::Get().Delete(*Filename, false, false, true);
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_V8CodeCacheHits);
+			}
+			return Script;
+		}
+
+		v8::ScriptCompiler::Source ScriptSource(Source, Origin);
+
+		auto Script = v8::ScriptCompiler::Compile(context, &ScriptSource, v8::ScriptCompiler::kProduceCodeCache);
+
+		auto Produced = ScriptSource.GetCachedData();
+		if (!Script.IsEmpty() && Produced && Produced->length > 0)
+		{
+			INC_DWORD_STAT(STAT_V8CodeCacheProduced);
+
+			FAsyncFileWriter::Get().WriteFile(Filename, TArray<uint8>(Produced->data, Produced->length));
+		}
+		return Script;
+	}
+
+private:
+	static FString GetFilename(const FString& Key)
+	{
+		return FPaths::GameSavedDir() / TEXT("Javascript") / TEXT("CodeCache") / FString::Printf(TEXT("%s-%08x.bin"), *Key, v8::ScriptCompiler::CachedDataVersionTag());
+	}
+};
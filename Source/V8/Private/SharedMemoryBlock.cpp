@@ -0,0 +1,47 @@
+PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
+
+#include "SharedMemoryBlock.h"
+#include "Translator.h"
+#include "Helpers.h"
+
+using namespace v8;
+
+void FSharedMemoryBlock::OpenNamed(const FunctionCallbackInfo<Value>& info)
+{
+	auto isolate = info.GetIsolate();
+
+	FIsolateHelper I(isolate);
+
+	if (info.Length() != 2 || !info[1]->IsNumber() || info[1]->NumberValue() <= 0)
+	{
+		I.Throw(TEXT("Shared memory requires a name and a positive size"));
+		return;
+	}
+
+	auto Name = StringFromV8(info[0]);
+	auto Block = FindOrCreate(Name, (size_t)info[1]->NumberValue());
+	if (!Block.IsValid())
+	{
+		I.Throw(FString::Printf(TEXT("Shared memory %s already exists with another size"), *Name));
+		return;
+	}
+
+	info.GetReturnValue().Set(Block->Bind(isolate));
+}
+
+void FSharedMemoryBlock::ReleaseShared(const FunctionCallbackInfo<Value>& info)
+{
+	auto isolate = info.GetIsolate();
+
+	FIsolateHelper I(isolate);
+
+	if (info.Length() != 1 || !info[0]->IsString())
+	{
+		I.Throw(TEXT("Releasing shared memory requires a name"));
+		return;
+	}
+
+	info.GetReturnValue().Set(ReleaseNamed(StringFromV8(info[0])));
+}
+
+PRAGMA_ENABLE_SHADOW_VARIABLE_WARNINGS
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Templates/RefCounting.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeLock.h"
+#include "ExternalMemory.h"
+
+/**
+* Memory behind the SharedArrayBuffers of several isolates, which may run on different threads.
+* Every SharedArrayBuffer created by Bind holds a reference until V8 collects it.
+* Named blocks are held by name as well, until ReleaseNamed or module shutdown, so that a consumer
+* opening a name after the producer's buffers were collected still finds the data.
+*/
+class FSharedMemoryBlock
+{
+public:
+	typedef TFunction<void(void*, size_t)> FDeleter;
+
+	/** Named in-process block, zero-filled on first use; returns null when it already exists with another size */
+	static TRefCountPtr<FSharedMemoryBlock> FindOrCreate(const FString& Name, size_t Size)
+	{
+		FScopeLock Lock(&GetLock());
+
+		if (auto Existing = GetNamedBlocks().Find(Name))
+		{
+			return (*Existing)->Size == Size ? *Existing : nullptr;
+		}
+
+		auto Data = FMemory::Malloc(Size, 16);
+		FMemory::Memzero(Data, Size);
+
+		auto Block = new FSharedMemoryBlock(Data, Size, [](void* Data, size_t) { FMemory::Free(Data); });
+		GetNamedBlocks().Add(Name, Block);
+		return Block;
+	}
+
+	/** Drops the name; the memory goes once no SharedArrayBuffer uses it any more. Returns whether the name existed */
+	static bool ReleaseNamed(const FString& Name)
+	{
+		TRefCountPtr<FSharedMemoryBlock> Block;
+		{
+			FScopeLock Lock(&GetLock());
+			GetNamedBlocks().RemoveAndCopyValue(Name, Block);
+		}
+		return Block.IsValid();
+	}
+
+	/** Drops every name; called at module shutdown */
+	static void ReleaseAllNamed()
+	{
+		TMap<FString, TRefCountPtr<FSharedMemoryBlock>> NamedBlocks;
+		{
+			FScopeLock Lock(&GetLock());
+			Swap(NamedBlocks, GetNamedBlocks());
+		}
+	}
+
+	/** Takes over Data, which Deleter releases once the last reference is gone; Deleter may run on any thread */
+	static TRefCountPtr<FSharedMemoryBlock> Adopt(void* Data, size_t Size, FDeleter Deleter)
+	{
+		FScopeLock Lock(&GetLock());
+
+		return new FSharedMemoryBlock(Data, Size, MoveTemp(Deleter));
+	}
+
+	/** Block behind a SharedArrayBuffer created by Bind, if any */
+	static TRefCountPtr<FSharedMemoryBlock> Find(void* Data)
+	{
+		FScopeLock Lock(&GetLock());
+
+		return GetBlocks().FindRef(Data);
+	}
+
+	/** Script entry point: (name, size) returns a SharedArrayBuffer over the named block */
+	static void OpenNamed(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+	/** Script entry point: (name) drops the named block, see ReleaseNamed */
+	static void ReleaseShared(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+	/** New SharedArrayBuffer over the whole block */
+	v8::Local<v8::SharedArrayBuffer> Bind(v8::Isolate* isolate)
+	{
+		auto Buffer = v8::SharedArrayBuffer::New(isolate, Data, Size, v8::ArrayBufferCreationMode::kExternalized);
+		Attach(isolate, Buffer);
+		return Buffer;
+	}
+
+	/** Keeps the block alive until Buffer, which has to be over its memory, is collected */
+	void Attach(v8::Isolate* isolate, v8::Local<v8::SharedArrayBuffer> Buffer)
+	{
+		auto Binding = new FBinding;
+		Binding->Block = this;
+		Binding->Handle.Reset(isolate, Buffer);
+		Binding->Handle.SetWeak(Binding, [](const v8::WeakCallbackInfo<FBinding>& data) {
+			auto Binding = data.GetParameter();
+			Binding->Handle.Reset();
+			delete Binding;
+		}, v8::WeakCallbackType::kParameter);
+
+		FExternalMemory::Track(isolate, Buffer, Size);
+	}
+
+	void* GetData() const { return Data; }
+	size_t GetSize() const { return Size; }
+
+	uint32 AddRef() const
+	{
+		return NumRefs.Increment();
+	}
+
+	uint32 Release() const
+	{
+		// Find and FindOrCreate take the same lock, so they never pick up a block on its way out
+		FScopeLock Lock(&GetLock());
+
+		auto Refs = NumRefs.Decrement();
+		if (Refs == 0)
+		{
+			delete this;
+		}
+		return Refs;
+	}
+
+	uint32 GetRefCount() const
+	{
+		return NumRefs.GetValue();
+	}
+
+private:
+	struct FBinding
+	{
+		TRefCountPtr<FSharedMemoryBlock> Block;
+		v8::Global<v8::SharedArrayBuffer> Handle;
+	};
+
+	FSharedMemoryBlock(void* InData, size_t InSize, FDeleter InDeleter)
+		: Data(InData), Size(InSize), Deleter(MoveTemp(InDeleter))
+	{
+		GetBlocks().Add(Data, this);
+	}
+
+	~FSharedMemoryBlock()
+	{
+		GetBlocks().Remove(Data);
+
+		Deleter(Data, Size);
+	}
+
+	void* Data;
+	size_t Size;
+	FDeleter Deleter;
+
+	mutable FThreadSafeCounter NumRefs;
+
+	static FCriticalSection& GetLock()
+	{
+		static FCriticalSection Lock;
+		return Lock;
+	}
+
+	static TMap<void*, FSharedMemoryBlock*>& GetBlocks()
+	{
+		static TMap<void*, FSharedMemoryBlock*> Blocks;
+		return Blocks;
+	}
+
+	static TMap<FString, TRefCountPtr<FSharedMemoryBlock>>& GetNamedBlocks()
+	{
+		static TMap<FString, TRefCountPtr<FSharedMemoryBlock>> NamedBlocks;
+		return NamedBlocks;
+	}
+};
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "Templates/RefCounting.h"
+#include "Containers/LockFreeFixedSizeAllocator.h"
+#include "HAL/ThreadSafeCounter.h"
+
 struct FObjectPropertyOwner : IPropertyOwner
 {
 	UObject* Object;
@@ -23,9 +27,16 @@ struct FStructMemoryPropertyOwner : IPropertyOwner
 	}
 };
 
+/** Struct instance exposed to V8; small structs are stored inline and instances come from a fixed-size block allocator */
 struct FStructMemoryInstance
-	: public TSharedFromThis<FStructMemoryInstance>
 {
+	/** Structs up to this size (FVector, FRotator, FLinearColor, ...) need no separate buffer */
+	enum
+	{
+		InlineSize = 64,
+		InlineAlignment = 16
+	};
+
 	FStructMemoryInstance(UScriptStruct* InStruct, const IPropertyOwner& InOwner, void* InSource)
 	: Struct(InStruct), Source(InSource)
 	{
@@ -39,7 +50,7 @@ struct FStructMemoryInstance
 			auto OwnerInstance = ((const FStructMemoryPropertyOwner&)InOwner).Memory;
 			if (OwnerInstance->Owner == EPropertyOwner::None)
 			{
-				Parent = OwnerInstance->AsShared();
+				Parent = OwnerInstance;
 			}
 			else if (OwnerInstance->Parent.IsValid())
 			{
@@ -53,12 +64,23 @@ struct FStructMemoryInstance
 
 		if (Owner == EPropertyOwner::None)
 		{
-			Buffer.AddUninitialized(Struct->GetStructureSize());
-			Struct->InitializeStruct(GetMemory());
+			Size = Struct->GetStructureSize();
+
+			const int32 Alignment = Struct->GetMinAlignment();
+			if (Size <= InlineSize && Alignment <= InlineAlignment)
+			{
+				Buffer = InlineBuffer.Pad;
+			}
+			else
+			{
+				Buffer = (uint8*)FMemory::Malloc(Size, Alignment);
+			}
+
+			Struct->InitializeStruct(Buffer);
 
 			if (Source)
 			{
-				Struct->CopyScriptStruct(GetMemory(), Source);
+				Struct->CopyScriptStruct(Buffer, Source);
 				Source = nullptr;
 			}
 		}
@@ -68,7 +90,12 @@ struct FStructMemoryInstance
 	{
 		if (Owner == EPropertyOwner::None)
 		{
-			Struct->DestroyStruct(GetMemory());
+			Struct->DestroyStruct(Buffer);
+
+			if (Buffer != InlineBuffer.Pad)
+			{
+				FMemory::Free(Buffer);
+			}
 		}
 	}
 
@@ -85,16 +112,46 @@ struct FStructMemoryInstance
 	void* Source;
 
 	// Parent instance
-	TSharedPtr<FStructMemoryInstance> Parent;
+	TRefCountPtr<FStructMemoryInstance> Parent;
+
+	// Independent memory buffer, either InlineBuffer or a heap block
+	uint8* Buffer{ nullptr };
+	int32 Size{ 0 };
+
+	TAlignedBytes<InlineSize, InlineAlignment> InlineBuffer;
+
+	// Intrusive reference count; instances are referenced by wrapper maps and child instances only
+	uint32 AddRef() const
+	{
+		return NumRefs.Increment();
+	}
+
+	uint32 Release() const
+	{
+		auto Refs = NumRefs.Decrement();
+		if (Refs == 0)
+		{
+			delete this;
+		}
+		return Refs;
+	}
+
+	uint32 GetRefCount() const
+	{
+		return NumRefs.GetValue();
+	}
 
-	// Independent memory buffer
-	TArray<uint8> Buffer;
+	// Bytes owned by this instance
+	int32 GetOwnedSize() const
+	{
+		return Owner == EPropertyOwner::None ? Size : 0;
+	}
 
 	uint8* GetMemory()
 	{
 		if (Owner == EPropertyOwner::None)
 		{
-			return Buffer.GetData();
+			return Buffer;
 		}
 		else if (Object.IsValid())
 		{
@@ -110,9 +167,9 @@ struct FStructMemoryInstance
 		}
 	}
 
-	static TSharedRef<FStructMemoryInstance> Create(UScriptStruct* Struct, const IPropertyOwner& InOwner, void* Source = nullptr)
+	static TRefCountPtr<FStructMemoryInstance> Create(UScriptStruct* Struct, const IPropertyOwner& InOwner, void* Source = nullptr)
 	{
-		return TSharedRef<FStructMemoryInstance>(new FStructMemoryInstance(Struct, InOwner, Source));
+		return TRefCountPtr<FStructMemoryInstance>(new FStructMemoryInstance(Struct, InOwner, Source));
 	}
 
 	static FStructMemoryInstance* FromV8(v8::Local<v8::Value> Value)
@@ -120,4 +177,31 @@ struct FStructMemoryInstance
 		auto Memory = RawMemoryFromV8(Value);
 		return reinterpret_cast<FStructMemoryInstance*>(Memory);
 	}	
-};
\ No newline at end of file
+
+	void* operator new(size_t InSize);
+	void operator delete(void* Ptr);
+
+private:
+	mutable FThreadSafeCounter NumRefs;
+};
+
+/** Instances are allocated in blocks of a single size which are recycled without going back to the general allocator */
+typedef TLockFreeFixedSizeAllocator<sizeof(FStructMemoryInstance), PLATFORM_CACHE_LINE_SIZE> FStructMemoryInstanceAllocator;
+
+/** Never destroyed: instances still held by leaked wrappers at exit would trip the allocator's destructor check */
+inline FStructMemoryInstanceAllocator& GetStructMemoryInstanceAllocator()
+{
+	static auto Allocator = new FStructMemoryInstanceAllocator;
+	return *Allocator;
+}
+
+inline void* FStructMemoryInstance::operator new(size_t InSize)
+{
+	check(InSize == sizeof(FStructMemoryInstance));
+	return GetStructMemoryInstanceAllocator().Allocate();
+}
+
+inline void FStructMemoryInstance::operator delete(void* Ptr)
+{
+	GetStructMemoryInstanceAllocator().Free(Ptr);
+}
@@ -2,6 +2,7 @@
 #include "Object.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "Engine/LatentActionManager.h"
 #include "Paths.h"
 #include "Config.h"
 #include "JavascriptIsolate_Private.h"
@@ -346,6 +347,7 @@ void FTypingsGenerator::ExportStruct(UStruct* source)
 
 		bool has_out_ref = false;
 		bool is_optional = false;
+		bool is_latent = false;
 
 		TArray<FString> Arguments;
 		for (TFieldIterator<UProperty> ParamIt(Function); ParamIt && (ParamIt->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++ParamIt)
@@ -358,6 +360,14 @@ void FTypingsGenerator::ExportStruct(UStruct* source)
 				is_optional = true;
 			}
 
+			// Latent info is filled in by the runtime, which returns a promise instead
+			auto StructProperty = Cast<UStructProperty>(*ParamIt);
+			if (StructProperty && StructProperty->Struct == FLatentActionInfo::StaticStruct())
+			{
+				is_latent = true;
+				is_optional = true;
+			}
+
 			auto Property = *ParamIt;
 			auto PropertyName = FV8Config::Safeify(Property->GetName());
 
@@ -380,7 +390,11 @@ void FTypingsGenerator::ExportStruct(UStruct* source)
 		w.push(FString::Join(Arguments, TEXT(",")));
 		w.push("): ");
 
-		if (has_out_ref)
+		if (is_latent)
+		{
+			w.push("Promise<void>");
+		}
+		else if (has_out_ref)
 		{
 			TArray<FString> Arguments;
 			for (UProperty* param : TFieldRange<UProperty>(Function))
@@ -5,6 +5,9 @@
 #include "Config.h"
 #include "Translator.h"
 #include "Exception.h"
+#include "JavascriptSettings.h"
+#include "UObjectIterator.h"
+#include "HAL/IConsoleManager.h"
 
 #include "JavascriptIsolate_Private.h"
 #include "JavascriptContext_Private.h"
@@ -19,10 +22,20 @@ UJavascriptIsolate::UJavascriptIsolate(const FObjectInitializer& ObjectInitializ
 	const bool bIsClassDefaultObject = IsTemplate(RF_ClassDefaultObject);
 	if (!bIsClassDefaultObject)
 	{
-		JavascriptIsolate = TSharedPtr<FJavascriptIsolate>(FJavascriptIsolate::Create());
+		Params = GetDefault<UJavascriptSettings>()->DefaultIsolateParams;
 	}
 }
 
+TSharedPtr<FJavascriptIsolate> UJavascriptIsolate::GetJavascriptIsolate()
+{
+	if (!JavascriptIsolate.IsValid() && !IsTemplate(RF_ClassDefaultObject))
+	{
+		JavascriptIsolate = TSharedPtr<FJavascriptIsolate>(FJavascriptIsolate::Create(Params));
+	}
+
+	return JavascriptIsolate;
+}
+
 void UJavascriptIsolate::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
 {
 	UJavascriptIsolate* This = CastChecked<UJavascriptIsolate>(InThis);
@@ -59,7 +72,7 @@ void UJavascriptIsolate::GetHeapStatistics(FJavascriptHeapStatistics& Statistics
 {
 	v8::HeapStatistics stats;
 
-	if (JavascriptIsolate.IsValid())
+	if (GetJavascriptIsolate().IsValid())
 	{
 		JavascriptIsolate->isolate_->GetHeapStatistics(&stats);
 
@@ -81,7 +94,7 @@ UJavascriptContext::UJavascriptContext(const FObjectInitializer& ObjectInitializ
 	if (!bIsClassDefaultObject)
 	{
 		auto Isolate = Cast<UJavascriptIsolate>(GetOuter());
-		JavascriptContext = TSharedPtr<FJavascriptContext>(FJavascriptContext::Create(Isolate->JavascriptIsolate,Paths));
+		JavascriptContext = TSharedPtr<FJavascriptContext>(FJavascriptContext::Create(Isolate->GetJavascriptIsolate(),Paths));
 
 		Expose("Context", this);
 
@@ -130,6 +143,11 @@ void UJavascriptContext::RunFile(FString Filename)
 	JavascriptContext->Public_RunFile(Filename);
 }
 
+void UJavascriptContext::RunModule(FString Filename)
+{
+	JavascriptContext->Public_RunModule(Filename);
+}
+
 FString UJavascriptContext::RunScript(FString Script, bool bOutput)
 {
 	return JavascriptContext->Public_RunScript(Script, bOutput);	
@@ -185,6 +203,44 @@ bool UJavascriptContext::CallProxyFunction(UObject* Holder, UObject* This, UFunc
 	return JavascriptContext->CallProxyFunction(Holder, This, FunctionToCall, Parms);
 }
 
+FJavascriptWrapperReport UJavascriptContext::GetWrapperStats()
+{
+	FJavascriptWrapperReport Report;
+	JavascriptContext->GetWrapperStats(Report);
+	return Report;
+}
+
+static void LogWrapperStats()
+{
+	for (TObjectIterator<UJavascriptContext> It; It; ++It)
+	{
+		UJavascriptContext* Context = *It;
+		if (!Context->JavascriptContext.IsValid())
+		{
+			continue;
+		}
+
+		auto Report = Context->GetWrapperStats();
+
+		UE_LOG(Javascript, Log, TEXT("Wrappers of %s"), Context->ContextId.IsValid() ? **Context->ContextId : *Context->GetName());
+		for (const auto& Stats : Report.Types)
+		{
+			UE_LOG(Javascript, Log, TEXT("  %-48s %8d (%+d) %10d bytes"), Stats.Type ? *Stats.Type->GetName() : TEXT("(gone)"), Stats.Count, Stats.Growth, Stats.NativeBytes);
+		}
+
+		UE_LOG(Javascript, Log, TEXT("Top retaining paths of %s"), Context->ContextId.IsValid() ? **Context->ContextId : *Context->GetName());
+		for (const auto& Path : Report.RetainingPaths)
+		{
+			UE_LOG(Javascript, Log, TEXT("  %-64s %8d"), *Path.Path, Path.Count);
+		}
+	}
+}
+
+static FAutoConsoleCommand GJavascriptWrapperStatsCommand(
+	TEXT("Javascript.WrapperStats"),
+	TEXT("Logs live wrappers per type, their growth since the last call and the script paths holding most of them, for every context"),
+	FConsoleCommandDelegate::CreateStatic(&LogWrapperStats));
+
 void UJavascriptContext::BeginDestroy()
 {
 	Super::BeginDestroy();
@@ -7,8 +7,23 @@ PRAGMA_DISABLE_SHADOW_VARIABLE_WARNINGS
 #include "IV8.h"
 #include "JavascriptStats.h"
 #include "JavascriptSettings.h"
+#include "Misc/CoreDelegates.h"
+#include "AsyncFileWriter.h"
+#include "Misc/QueuedThreadPool.h"
+#include "ScriptArchive.h"
+#include "SharedMemoryBlock.h"
 
 DEFINE_STAT(STAT_V8IdleTask);
+DEFINE_STAT(STAT_V8IdleGarbageCollection);
+DEFINE_STAT(STAT_V8IdleTimeGranted);
+DEFINE_STAT(STAT_V8IdleNotifications);
+DEFINE_STAT(STAT_V8BackgroundTask);
+DEFINE_STAT(STAT_V8BackgroundTasksQueued);
+DEFINE_STAT(STAT_V8CodeCacheHits);
+DEFINE_STAT(STAT_V8CodeCacheRejected);
+DEFINE_STAT(STAT_V8CodeCacheProduced);
+DEFINE_STAT(STAT_JsonDecode);
+DEFINE_STAT(STAT_JsonParse);
 DEFINE_STAT(STAT_JavascriptDelegate);
 DEFINE_STAT(STAT_JavascriptProxy);
 DEFINE_STAT(STAT_Scavenge);
@@ -28,6 +43,14 @@ DEFINE_STAT(STAT_CodeSpace);
 DEFINE_STAT(STAT_MapSpace);
 DEFINE_STAT(STAT_LoSpace);
 
+DEFINE_STAT(STAT_JavascriptExternalMemory);
+
+DEFINE_STAT(STAT_ArrayBufferLive);
+DEFINE_STAT(STAT_ArrayBufferPeak);
+DEFINE_STAT(STAT_ArrayBufferPooled);
+DEFINE_STAT(STAT_ArrayBufferAllocations);
+DEFINE_STAT(STAT_ArrayBufferAllocatedBytes);
+
 using namespace v8;
 
 static float GV8IdleTaskBudget = 1 / 60.0f;
@@ -35,7 +58,18 @@ static float GV8IdleTaskBudget = 1 / 60.0f;
 UJavascriptSettings::UJavascriptSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	V8Flags = TEXT("--harmony --harmony-shipping --es-staging --expose-gc");
+	V8Flags = TEXT("--harmony --harmony-shipping --es-staging --harmony-sharedarraybuffer --harmony-dynamic-import --expose-gc");
+	GarbageCollectionPolicy = EJavascriptGarbageCollectionPolicy::IdleTimeHints;
+	bCodeCache = true;
+#if !WITH_EDITOR
+	// The editor works on loose scripts, so that they can be edited
+	ScriptArchives.Add(TEXT("Scripts.jsar"));
+#endif
+	BackgroundThreads = 0;
+	BackgroundThreadPriority = EJavascriptThreadPriority::BelowNormal;
+	IdleHintLeadTime = 2.0f;
+	IdleHintStepBudgetMs = 1.0f;
+	IdleHintFinalBudgetMs = 2.0f;
 }
 
 void UJavascriptSettings::Apply() const
@@ -43,15 +77,75 @@ void UJavascriptSettings::Apply() const
 	IV8::Get().SetFlagsFromString(V8Flags);
 }
 
+/** V8 background task, run by the dedicated pool */
+class FV8BackgroundWork : public IQueuedWork
+{
+public:
+	FV8BackgroundWork(v8::Task* InTask)
+		: Task(InTask)
+	{
+		INC_DWORD_STAT(STAT_V8BackgroundTasksQueued);
+	}
+
+	virtual void DoThreadedWork() override
+	{
+		Run();
+	}
+
+	/** V8 may block on its background jobs (e.g. concurrent marking), so abandoned work runs anyway */
+	virtual void Abandon() override
+	{
+		Run();
+	}
+
+private:
+	v8::Task* Task;
+
+	void Run()
+	{
+		DEC_DWORD_STAT(STAT_V8BackgroundTasksQueued);
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_V8BackgroundTask);
+			Task->Run();
+		}
+
+		delete Task;
+		delete this;
+	}
+};
+
 class FUnrealJSPlatform : public v8::Platform
 {
 private:
 	v8::Platform* platform_;
+
+	/** Threads for V8 background work, which parses and compiles too */
+	FQueuedThreadPool* BackgroundPool{ nullptr };
+	int32 NumBackgroundThreads{ 0 };
 	TQueue<v8::IdleTask*> IdleTasks;
-	FTickerDelegate TickDelegate;
-	FDelegateHandle TickHandle;
+	FDelegateHandle BeginFrameHandle;
+	FDelegateHandle EndFrameHandle;
 	bool bActive{ true };
 
+	/** When game thread work of the current frame started */
+	double FrameStartTime{ 0 };
+
+	/** Isolates which take turns at idle-time GC; the only ones whose idle tasks run here, on the game thread */
+	TArray<Isolate*> IdleTimeIsolates;
+	mutable FCriticalSection IdleTimeIsolatesLock;
+	int32 NextIdleTimeIsolate{ 0 };
+
+	/** Wakes the thread of an isolate, which would otherwise have to poll for foreground tasks */
+	struct FForegroundWaiter
+	{
+		FEvent* Event;
+		/** When delayed tasks come due */
+		TArray<double> DueTimes;
+	};
+	TMap<Isolate*, FForegroundWaiter> ForegroundWaiters;
+	FCriticalSection ForegroundWaitersLock;
+
 public:
 	v8::Platform* platform() const
 	{
@@ -60,39 +154,131 @@ public:
 	FUnrealJSPlatform() 
 		: platform_(platform::CreateDefaultPlatform(0, platform::IdleTaskSupport::kEnabled))
 	{
-		TickDelegate = FTickerDelegate::CreateRaw(this, &FUnrealJSPlatform::HandleTicker);
-		TickHandle = FTicker::GetCoreTicker().AddTicker(TickDelegate);
+		BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddRaw(this, &FUnrealJSPlatform::HandleBeginFrame);
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FUnrealJSPlatform::HandleEndFrame);
 	}
 
 	~FUnrealJSPlatform()
 	{
-		FTicker::GetCoreTicker().RemoveTicker(TickHandle);
+		FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
 		delete platform_;
 	}
 
+	void AddIdleTimeIsolate(Isolate* isolate)
+	{
+		FScopeLock Lock(&IdleTimeIsolatesLock);
+		IdleTimeIsolates.AddUnique(isolate);
+	}
+
+	void RemoveIdleTimeIsolate(Isolate* isolate)
+	{
+		FScopeLock Lock(&IdleTimeIsolatesLock);
+		IdleTimeIsolates.Remove(isolate);
+	}
+
+	/**
+	* Has to be called before V8 is initialized; 0 threads means as many as the engine spawns task graph workers.
+	* Task graph workers are not used, as V8 sizes the stack limit of background parsing by --stack-size (984KB by default)
+	* from wherever the task starts, which their stacks cannot accommodate.
+	*/
+	void ConfigureBackgroundThreads(int32 NumThreads, EThreadPriority Priority)
+	{
+		if (NumThreads <= 0)
+		{
+			NumThreads = FMath::Max(FPlatformMisc::NumberOfWorkerThreadsToSpawn(), 1);
+		}
+
+		BackgroundPool = FQueuedThreadPool::Allocate();
+		verify(BackgroundPool->Create(NumThreads, IV8::ThreadStackSize, Priority));
+		NumBackgroundThreads = NumThreads;
+	}
+
 	void Shutdown()
 	{
 		bActive = false;
 		RunIdleTasks(FLT_MAX);
+
+		if (BackgroundPool)
+		{
+			BackgroundPool->Destroy();
+			delete BackgroundPool;
+			BackgroundPool = nullptr;
+		}
 	}
 	
-	virtual size_t NumberOfAvailableBackgroundThreads() { return platform_->NumberOfAvailableBackgroundThreads(); }
+	virtual size_t NumberOfAvailableBackgroundThreads() { return NumBackgroundThreads; }
 
+	/** Never reaches the default platform, so that its own worker threads are never started */
 	virtual void CallOnBackgroundThread(Task* task,
 		ExpectedRuntime expected_runtime)
 	{
-		platform_->CallOnBackgroundThread(task, expected_runtime);
+		check(BackgroundPool);
+		BackgroundPool->AddQueuedWork(new FV8BackgroundWork(task));
 	}
 
 	virtual void CallOnForegroundThread(Isolate* isolate, Task* task)
 	{
 		platform_->CallOnForegroundThread(isolate, task);
+
+		FScopeLock Lock(&ForegroundWaitersLock);
+		if (auto Waiter = ForegroundWaiters.Find(isolate))
+		{
+			Waiter->Event->Trigger();
+		}
 	}
 
 	virtual void CallDelayedOnForegroundThread(Isolate* isolate, Task* task,
 		double delay_in_seconds)
 	{
 		platform_->CallDelayedOnForegroundThread(isolate, task, delay_in_seconds);
+
+		FScopeLock Lock(&ForegroundWaitersLock);
+		if (auto Waiter = ForegroundWaiters.Find(isolate))
+		{
+			// Woken to shorten its wait
+			Waiter->DueTimes.Add(MonotonicallyIncreasingTime() + delay_in_seconds);
+			Waiter->Event->Trigger();
+		}
+	}
+
+	void SetForegroundTaskEvent(Isolate* isolate, FEvent* Event)
+	{
+		FScopeLock Lock(&ForegroundWaitersLock);
+		if (Event)
+		{
+			ForegroundWaiters.Add(isolate, { Event });
+		}
+		else
+		{
+			ForegroundWaiters.Remove(isolate);
+		}
+	}
+
+	/** Due tasks are forgotten once reported, as the thread pumps its message loop before waiting again */
+	uint32 GetForegroundTaskWaitTime(Isolate* isolate)
+	{
+		FScopeLock Lock(&ForegroundWaitersLock);
+		auto Waiter = ForegroundWaiters.Find(isolate);
+		if (!Waiter || Waiter->DueTimes.Num() == 0)
+		{
+			return MAX_uint32;
+		}
+
+		const double Now = MonotonicallyIncreasingTime();
+		const int32 NumDueTimes = Waiter->DueTimes.Num();
+		Waiter->DueTimes.RemoveAll([Now](double DueTime) { return DueTime <= Now; });
+		if (Waiter->DueTimes.Num() < NumDueTimes)
+		{
+			return 0;
+		}
+
+		double NextDueTime = Waiter->DueTimes[0];
+		for (auto DueTime : Waiter->DueTimes)
+		{
+			NextDueTime = FMath::Min(NextDueTime, DueTime);
+		}
+		return (uint32)FMath::CeilToInt((NextDueTime - Now) * 1000);
 	}
 
 	virtual void CallIdleOnForegroundThread(Isolate* isolate, IdleTask* task) 
@@ -100,9 +286,11 @@ public:
 		IdleTasks.Enqueue(task);
 	}
 
+	/** Isolates on other threads (workers) get no idle tasks, as those run on the game thread */
 	virtual bool IdleTasksEnabled(Isolate* isolate) 
 	{
-		return bActive;
+		FScopeLock Lock(&IdleTimeIsolatesLock);
+		return bActive && IdleTimeIsolates.Contains(isolate);
 	}
 
 	virtual double MonotonicallyIncreasingTime()
@@ -133,10 +321,51 @@ public:
 		}
 	}
 
-	bool HandleTicker(float DeltaTime)
-	{	
-		RunIdleTasks(FMath::Max<float>(0, GV8IdleTaskBudget - DeltaTime));
-		return true;
+	/**
+	* Gives isolates idle time for GC until Budget runs out.
+	* Each frame starts with the isolate after the one served first last time, so none is starved.
+	*/
+	void RunIdleGarbageCollection(float Budget)
+	{
+		if (Budget <= 0 || IdleTimeIsolates.Num() == 0)
+		{
+			return;
+		}
+
+		INC_FLOAT_STAT_BY(STAT_V8IdleTimeGranted, Budget * 1000.0f);
+
+		const double Deadline = MonotonicallyIncreasingTime() + Budget;
+		for (int32 Turn = 0; Turn < IdleTimeIsolates.Num() && MonotonicallyIncreasingTime() < Deadline; ++Turn)
+		{
+			NextIdleTimeIsolate = NextIdleTimeIsolate % IdleTimeIsolates.Num();
+			auto isolate = IdleTimeIsolates[NextIdleTimeIsolate];
+
+			{
+				SCOPE_CYCLE_COUNTER(STAT_V8IdleGarbageCollection);
+				INC_DWORD_STAT(STAT_V8IdleNotifications);
+
+				// Returns early when the isolate has nothing left to do, leaving time for the next one
+				Isolate::Scope isolate_scope(isolate);
+				isolate->IdleNotificationDeadline(Deadline);
+			}
+
+			++NextIdleTimeIsolate;
+		}
+	}
+
+	void HandleBeginFrame()
+	{
+		FrameStartTime = FPlatformTime::Seconds();
+	}
+
+	/** Slack is what is left of the frame budget after game thread work of this frame */
+	void HandleEndFrame()
+	{
+		const float Budget = FMath::Max<float>(0, GV8IdleTaskBudget - (FPlatformTime::Seconds() - FrameStartTime));
+		const double Start = FPlatformTime::Seconds();
+
+		RunIdleTasks(Budget);
+		RunIdleGarbageCollection(Budget - (FPlatformTime::Seconds() - Start));
 	}
 };
 
@@ -160,6 +389,18 @@ public:
 		const UJavascriptSettings& Settings = *GetDefault<UJavascriptSettings>();
 		Settings.Apply();
 
+		static const EThreadPriority Priorities[] = { TPri_Normal, TPri_BelowNormal, TPri_Lowest };
+		platform_.ConfigureBackgroundThreads(Settings.BackgroundThreads, Priorities[(int32)Settings.BackgroundThreadPriority]);
+
+		for (const auto& Archive : Settings.ScriptArchives)
+		{
+			auto Filename = FPaths::GameContentDir() / Archive;
+			if (!FScriptArchive::Mount(Filename))
+			{
+				UE_LOG(Javascript, Verbose, TEXT("Script archive not mounted: %s"), *Filename);
+			}
+		}
+
 		V8::InitializeICU();
 		V8::InitializePlatform(&platform_);
 		V8::Initialize();
@@ -172,8 +413,13 @@ public:
 	{		
 		platform_.Shutdown();
 
+		FAsyncFileWriter::Shutdown();
+
 		V8::Dispose();
 		V8::ShutdownPlatform();
+
+		FScriptArchive::UnmountAll();
+		FSharedMemoryBlock::ReleaseAllNamed();
 	}
 
 	//@HACK
@@ -312,10 +558,35 @@ public:
 		GV8IdleTaskBudget = BudgetInSeconds;
 	}
 
+	virtual void AddIdleTimeIsolate(void* Isolate) override
+	{
+		platform_.AddIdleTimeIsolate(reinterpret_cast<v8::Isolate*>(Isolate));
+	}
+
+	virtual void RemoveIdleTimeIsolate(void* Isolate) override
+	{
+		platform_.RemoveIdleTimeIsolate(reinterpret_cast<v8::Isolate*>(Isolate));
+	}
+
 	virtual void* GetV8Platform() override
 	{
 		return platform_.platform();
 	}
+
+	virtual void CallOnBackgroundThread(void* Task) override
+	{
+		platform_.CallOnBackgroundThread(reinterpret_cast<v8::Task*>(Task), v8::Platform::kShortRunningTask);
+	}
+
+	virtual void SetForegroundTaskEvent(void* Isolate, FEvent* Event) override
+	{
+		platform_.SetForegroundTaskEvent(reinterpret_cast<v8::Isolate*>(Isolate), Event);
+	}
+
+	virtual uint32 GetForegroundTaskWaitTime(void* Isolate) override
+	{
+		return platform_.GetForegroundTaskWaitTime(reinterpret_cast<v8::Isolate*>(Isolate));
+	}
 };
 
 IMPLEMENT_MODULE(V8Module, V8)
@@ -2,6 +2,8 @@
 
 #include "ModuleManager.h"
 
+class FEvent;
+
 /**
 * The public interface to this module. 
 */
@@ -19,6 +21,9 @@ public:
 		return FModuleManager::Get().IsModuleLoaded("V8");
 	}	
 
+	/** Stack size of threads which run V8, which limits its stack by --stack-size (984KB by default) */
+	static const uint32 ThreadStackSize = 2 * 1024 * 1024;
+
 	virtual void AddGlobalScriptSearchPath(const FString& Path) = 0;
 	virtual void RemoveGlobalScriptSearchPath(const FString& Path) = 0;
 	virtual TArray<FString> GetGlobalScriptSearchPaths() = 0;
@@ -30,5 +35,18 @@ public:
 	virtual void SetFlagsFromString(const FString& Flags) = 0;
 	virtual void SetIdleTaskBudget(float BudgetInSeconds) = 0;
 
+	/** Isolates registered here are given idle time for GC at the end of each frame (v8::Isolate*) */
+	virtual void AddIdleTimeIsolate(void* Isolate) = 0;
+	virtual void RemoveIdleTimeIsolate(void* Isolate) = 0;
+
 	virtual void* GetV8Platform() = 0;
+
+	/** Runs a v8::Task on V8's background threads, which have the stack that parsing needs, and deletes it */
+	virtual void CallOnBackgroundThread(void* Task) = 0;
+
+	/** Triggers Event whenever V8 posts a foreground task for an isolate which runs on a thread of its own; null stops it (v8::Isolate*) */
+	virtual void SetForegroundTaskEvent(void* Isolate, FEvent* Event) = 0;
+
+	/** How long that thread may wait for its event before a delayed foreground task comes due, in ms; MAX_uint32 when none is pending */
+	virtual uint32 GetForegroundTaskWaitTime(void* Isolate) = 0;
 };
@@ -17,6 +17,56 @@ struct V8_API FArrayBufferAccessor
 	static void Discard();
 };
 
+USTRUCT(BlueprintType)
+struct V8_API FJavascriptWrapperStats
+{
+	GENERATED_BODY()
+
+	/** UClass or UScriptStruct of the wrapped instances */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	UStruct* Type{ nullptr };
+
+	/** Live wrappers */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	int32 Count{ 0 };
+
+	/** Native bytes behind the wrappers; instance size for objects, owned memory for structs */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	int32 NativeBytes{ 0 };
+
+	/** Change of Count since the previous report */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	int32 Growth{ 0 };
+};
+
+USTRUCT(BlueprintType)
+struct V8_API FJavascriptRetainingPath
+{
+	GENERATED_BODY()
+
+	/** Script path of an object or array, e.g. "global.cache.actors[]" */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	FString Path;
+
+	/** Wrappers held directly by it */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	int32 Count{ 0 };
+};
+
+USTRUCT(BlueprintType)
+struct V8_API FJavascriptWrapperReport
+{
+	GENERATED_BODY()
+
+	/** Sorted by native bytes, largest first */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	TArray<FJavascriptWrapperStats> Types;
+
+	/** Script paths holding most wrappers, found by walking the global object and loaded modules */
+	UPROPERTY(BlueprintReadOnly, Category = "Scripting | Javascript")
+	TArray<FJavascriptRetainingPath> RetainingPaths;
+};
+
 UCLASS()
 class V8_API UJavascriptContext : public UObject
 {
@@ -50,6 +100,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
 	void RunFile(FString Filename);
 
+	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
+	void RunModule(FString Filename);
+
 	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
 	FString RunScript(FString Script, bool bOutput = true);
 
@@ -77,6 +130,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
 	void DestroyInspector();
 
+	/** Reports live wrappers of this context, to track down scripts which retain them */
+	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
+	FJavascriptWrapperReport GetWrapperStats();
+
 	bool HasProxyFunction(UObject* Holder, UFunction* Function);
 	bool CallProxyFunction(UObject* Holder, UObject* This, UFunction* Function, void* Parms);
 };
\ No newline at end of file
@@ -4,14 +4,13 @@
 
 class FJavascriptDelegate;
 
+/** Bound to an engine delegate on behalf of all JavaScript listeners of it */
 UCLASS()
 class V8_API UJavascriptDelegate : public UObject
 {
 	GENERATED_BODY()
 
 public:
-	int32 UniqueId;
-
 	TWeakPtr<FJavascriptDelegate> JavascriptDelegate;	
 
 	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
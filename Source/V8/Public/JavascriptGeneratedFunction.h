@@ -12,5 +12,14 @@ class V8_API UJavascriptGeneratedFunction : public UFunction
 public:		
 	TWeakPtr<FJavascriptContext> JavascriptContext;	
 
+	/** Return parameter, if any (cached when the function is finalized) */
+	UProperty* ReturnParam{ nullptr };
+
+	/** One entry per out parm record on the stack; true when the record has to be written back to the caller */
+	TArray<bool> OutParmsToCopy;
+
+	/** Whether the VM frame holds parameters which aren't initialized while evaluating arguments */
+	bool bFrameNeedsZeroing{ true };
+
 	DECLARE_FUNCTION(Thunk);
 };
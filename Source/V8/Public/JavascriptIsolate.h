@@ -88,6 +88,65 @@ struct V8_API FJavascriptHeapStatistics
 	bool bDoesZapGarbage;
 };
 
+UENUM(BlueprintType)
+enum class EJavascriptHeapLimitAction : uint8
+{
+	/** Grant half of the headroom once, terminate when that is exhausted too */
+	RaiseOnce,
+	/** Terminate execution right away */
+	Terminate,
+};
+
+USTRUCT(BlueprintType)
+struct V8_API FJavascriptIsolateParams
+{
+	GENERATED_BODY()
+
+	/** Recycle small ArrayBuffer blocks through size-class free lists */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	bool bPoolArrayBuffers{ true };
+
+	/** Take ArrayBuffer blocks over 1MB from the OS as zero-filled pages instead of clearing them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	bool bLazyZeroLargeArrayBuffers{ true };
+
+	/** Upper bound of memory kept in ArrayBuffer free lists (MB) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	int32 MaxPooledArrayBufferMB{ 16 };
+
+	/** Old generation limit (MB); 0 keeps the V8 default and disables near-heap-limit handling */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	int32 MaxOldSpaceSizeMB{ 0 };
+
+	/** Young generation semi-space limit (MB); 0 keeps the V8 default */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	int32 MaxSemiSpaceSizeMB{ 0 };
+
+	/** Extra old generation reserved above MaxOldSpaceSizeMB, so that the isolate survives reaching its limit (MB) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	int32 HeapLimitHeadroomMB{ 64 };
+
+	/** What happens when live heap reaches MaxOldSpaceSizeMB */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	EJavascriptHeapLimitAction NearHeapLimitAction{ EJavascriptHeapLimitAction::RaiseOnce };
+
+	/** Write a heap snapshot to Saved/Javascript when live heap reaches MaxOldSpaceSizeMB */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	bool bSnapshotNearHeapLimit{ true };
+
+	/** Run the sampling heap profiler for the whole lifetime of the isolate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	bool bSamplingHeapProfiler{ false };
+
+	/** Average number of bytes allocated between samples (KB) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	int32 SamplingHeapProfilerIntervalKB{ 512 };
+
+	/** Seconds between allocation profiles written to Saved/Javascript; 0 disables periodic export */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting | Javascript")
+	float AllocationProfileExportInterval{ 60.0f };
+};
+
 UCLASS()
 class V8_API UJavascriptIsolate : public UObject
 {
@@ -96,8 +155,15 @@ class V8_API UJavascriptIsolate : public UObject
 public:
 	virtual void BeginDestroy() override;
 
+	/** Applied when the isolate is created, on first use; defaults come from JavascriptSettings */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scripting|Javascript")
+	FJavascriptIsolateParams Params;
+
+	/** Created on first use */
 	TSharedPtr<FJavascriptIsolate> JavascriptIsolate;
 
+	TSharedPtr<FJavascriptIsolate> GetJavascriptIsolate();
+
 	UFUNCTION(BlueprintCallable, Category = "Scripting|Javascript")
 	UJavascriptContext* CreateContext();
 
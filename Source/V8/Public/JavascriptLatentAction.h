@@ -0,0 +1,18 @@
+#pragma once
+
+#include "JavascriptLatentAction.generated.h"
+
+class FJavascriptIsolate;
+
+/** Callback target of latent actions started from JavaScript; resolves the promise returned to the caller */
+UCLASS()
+class V8_API UJavascriptLatentAction : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	FJavascriptIsolate* JavascriptIsolate{ nullptr };
+
+	UFUNCTION()
+	void Resume(int32 Linkage);
+};
@@ -1,7 +1,29 @@
 #pragma once
 
+#include "JavascriptIsolate.h"
 #include "JavascriptSettings.generated.h"
 
+UENUM()
+enum class EJavascriptGarbageCollectionPolicy : uint8
+{
+	/** V8 collects on its own schedule only */
+	Independent,
+	/**
+	* V8 is given idle time ahead of engine GC and once more when it begins. These are hints only: V8's heuristics
+	* decide whether marking starts or finishes, so wrappers may release their objects only after engine GC.
+	*/
+	IdleTimeHints UMETA(DisplayName = "Idle-Time Hints"),
+	/** Full V8 collection whenever engine GC begins */
+	Forced,
+};
+
+UENUM()
+enum class EJavascriptThreadPriority : uint8
+{
+	Normal,
+	BelowNormal,
+	Lowest,
+};
 
 UCLASS(config = Engine, defaultconfig)
 class V8_API UJavascriptSettings
@@ -9,11 +31,61 @@ class V8_API UJavascriptSettings
 {
 	GENERATED_UCLASS_BODY()
 
-public:	
+public:
 	UPROPERTY(EditAnywhere, config, Category = Javascript, meta = (
 		ConsoleVariable = "unrealjs.v8flags", DisplayName = "V8 Flags",
 		ToolTip = "V8 Flags. Please refer to V8 documentation"))
-	FString V8Flags;	
+	FString V8Flags;
+
+	UPROPERTY(EditAnywhere, config, Category = Javascript, meta = (
+		DisplayName = "Code Cache",
+		ToolTip = "Keep V8 code caches of required modules and run files under Saved/Javascript/CodeCache"))
+	bool bCodeCache;
+
+	UPROPERTY(EditAnywhere, config, Category = Javascript, meta = (
+		DisplayName = "Preload Modules",
+		ToolTip = "Modules compiled on a background thread as soon as a context is created, so that require() only has to run them"))
+	TArray<FString> PreloadModules;
+
+	UPROPERTY(EditAnywhere, config, Category = Javascript, meta = (
+		DisplayName = "Script Archives",
+		ToolTip = "Archives built with Javascript.BuildScriptArchive, relative to the game content directory. Foo.jsar is mounted in place of the directory Foo; missing archives are skipped. Games mount Scripts.jsar unless configured otherwise; the editor mounts none"))
+	TArray<FString> ScriptArchives;
+
+	UPROPERTY(EditAnywhere, config, Category = GarbageCollection, meta = (
+		DisplayName = "Garbage Collection Policy",
+		ToolTip = "How V8 garbage collection is coordinated with engine garbage collection"))
+	EJavascriptGarbageCollectionPolicy GarbageCollectionPolicy;
+
+	UPROPERTY(EditAnywhere, config, Category = GarbageCollection, meta = (
+		ClampMin = "0", UIMin = "0", DisplayName = "Idle Hint Lead Time",
+		ToolTip = "Seconds before engine GC during which V8 is given idle time every tick (Idle-Time Hints policy). V8 may spend it on incremental marking or ignore it"))
+	float IdleHintLeadTime;
+
+	UPROPERTY(EditAnywhere, config, Category = GarbageCollection, meta = (
+		ClampMin = "0", UIMin = "0", DisplayName = "Idle Hint Step Budget (ms)",
+		ToolTip = "Idle time given to V8 every tick within the lead time; 0 leaves V8 the idle time left over at the end of frames only (Idle-Time Hints policy)"))
+	float IdleHintStepBudgetMs;
+
+	UPROPERTY(EditAnywhere, config, Category = GarbageCollection, meta = (
+		ClampMin = "0", UIMin = "0", DisplayName = "Idle Hint Final Budget (ms)",
+		ToolTip = "Idle time given to V8 when engine GC begins (Idle-Time Hints policy). Nothing is forced to finish within it; unreachable wrappers may keep their objects until a later V8 collection"))
+	float IdleHintFinalBudgetMs;
+
+	UPROPERTY(EditAnywhere, config, Category = Threading, meta = (
+		ClampMin = "0", UIMin = "0", DisplayName = "Background Threads",
+		ToolTip = "Threads dedicated to V8 background work (concurrent marking, compilation, sweeping, streamed parsing); 0 spawns as many as the engine spawns task graph workers"))
+	int32 BackgroundThreads;
+
+	UPROPERTY(EditAnywhere, config, Category = Threading, meta = (
+		DisplayName = "Background Thread Priority",
+		ToolTip = "Priority of dedicated V8 background threads"))
+	EJavascriptThreadPriority BackgroundThreadPriority;
+
+	UPROPERTY(EditAnywhere, config, Category = Isolate, meta = (
+		DisplayName = "Default Isolate Parameters",
+		ToolTip = "Parameters of newly created isolates, unless overridden per isolate"))
+	FJavascriptIsolateParams DefaultIsolateParams;
 
 	void Apply() const;
 };